@@ -33,6 +33,7 @@ SOURCES += \
 	base64/cdecode.cpp \
 	base64/cencode.cpp \
 	column.cpp \
+	columnemptyvalues.cpp \
 	columns.cpp \
 	datablock.cpp \
 	dataset.cpp \
@@ -43,11 +44,13 @@ SOURCES += \
 	labels.cpp \
 	processinfo.cpp \
 	sharedmemory.cpp \
+	stringdictionary.cpp \
 	tempfiles.cpp \
 	utils.cpp \
 	version.cpp \
   enginedefinitions.cpp \
   timers.cpp \
+  tracer.cpp \
     stringutils.cpp \
     log.cpp
 
@@ -69,6 +72,7 @@ HEADERS += \
 	boost/nowide/system.hpp \
 	boost/nowide/windows.hpp \
 	column.h \
+	columnemptyvalues.h \
 	columns.h \
 	common.h \
 	datablock.h \
@@ -82,12 +86,14 @@ HEADERS += \
 	libzip/archive_entry.h \
 	processinfo.h \
 	sharedmemory.h \
+	stringdictionary.h \
 	tempfiles.h \
 	utils.h \
 	version.h \
   jsonredirect.h \
   enginedefinitions.h \
   timers.h \
+  tracer.h \
   enumutilities.h \
     stringutils.h \
     log.h
@@ -17,6 +17,7 @@
 
 #include "column.h"
 #include "utils.h"
+#include "stringdictionary.h"
 
 
 #include <sstream>
@@ -25,7 +26,10 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <cmath>
+#include <climits>
+#include <atomic>
 #include "log.h"
+#include "processinfo.h"
 
 using namespace boost::interprocess;
 using namespace boost;
@@ -44,11 +48,47 @@ Column &Column::operator=(const Column &column)
 		this->_columnType = column._columnType;
 		this->_blocks = column._blocks;
 		this->_labels = column._labels;
+		this->_version = column._version;
+		this->_revision = column._revision;
 	}
 
 	return *this;
 }
 
+void Column::_copyContentsFrom(const Column & other)
+{
+	// Unlike operator= this gets its own blocks, so other can be changed afterwards without this noticing
+	Column & source = const_cast<Column&>(other); // Ints and Doubles only have non-const iterators
+
+	_name		= other._name;
+	_columnType	= other._columnType;
+	_labels		= other._labels;
+	_version	= other._version;
+	_revision	= other._revision;
+
+	_setRowCount(other._rowCount);
+
+	if (_columnType == Column::ColumnTypeScale)
+	{
+		std::vector<double> values(source.AsDoubles.begin(), source.AsDoubles.end());
+		setValues(0, values.data(), int(values.size()));
+	}
+	else
+	{
+		std::vector<int> values(source.AsInts.begin(), source.AsInts.end());
+		setValues(0, values.data(), int(values.size()));
+	}
+}
+
+void Column::_destroyBlocks(SegmentManager *mem)
+{
+	for (BlockEntry & block : _blocks)
+		mem->destroy_ptr(block.second.get());
+
+	_blocks.clear();
+	_rowCount = 0;
+}
+
 Labels &Column::labels()
 {
 	return _labels;
@@ -56,16 +96,12 @@ Labels &Column::labels()
 
 bool Column::isEmptyValue(const string& val)
 {
-	if (val.empty()) return true;
-	const vector<string>& emptyValues = Utils::getEmptyValues();
-	return std::find(emptyValues.begin(), emptyValues.end(), val) != emptyValues.end();
+	return Utils::isEmptyValue(val);
 }
 
 bool Column::isEmptyValue(const double &val)
 {
-	if (std::isnan(val)) return true;
-	const vector<double>& emptyValues = Utils::getDoubleEmptyValues();
-	return std::find(emptyValues.begin(), emptyValues.end(), val) != emptyValues.end();
+	return Utils::isEmptyValue(val);
 }
 
 void Column::_convertVectorIntToDouble(vector<int> &intValues, vector<double> &doubleValues)
@@ -82,158 +118,169 @@ void Column::_convertVectorIntToDouble(vector<int> &intValues, vector<double> &d
 
 }
 
-bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
+bool Column::_resetEmptyValuesForNominal(ColumnEmptyValues &emptyValues)
 {
-	bool hasChanged = false;
-	std::map<int, string> emptyValuesMapOrg = emptyValuesMap;
-	int row = 0;
-	bool hasEmptyValues = !emptyValuesMap.empty();
-	bool changeToNominalText = false;
-	Ints::iterator ints = AsInts.begin();
-	Ints::iterator end = AsInts.end();
-
-	set<int> uniqueValues = _labels.getIntValues();
+	bool		hasChanged	= false;
+	set<int>	uniqueValues = _labels.getIntValues();
 
-	for (; ints != end; ints++)
+	// The cells that were empty are all in emptyValues, so only those need to be looked at to find the ones that aren't empty anymore
+	std::map<int, int> restored; // row -> value
+	for (size_t i = 0; i < emptyValues.size(); i++)
 	{
-		int intValue = *ints;
-		if (intValue == INT_MIN && hasEmptyValues)
+		const string &orgValue = emptyValues.value(i);
+		if (emptyValues.row(i) >= int(_rowCount) || isEmptyValue(orgValue))
+			continue;
+
+		int intValue;
+		if (!Utils::getIntValue(orgValue, intValue))
 		{
-			auto search = emptyValuesMap.find(row);
-			if (search != emptyValuesMap.end())
-			{
-				string orgValue = search->second;
-				if (!isEmptyValue(orgValue))
-				{
-					// This value is not empty anymore
-					if (Utils::getIntValue(orgValue, intValue))
-					{
-						*ints = intValue;
-						uniqueValues.insert(intValue);
-						hasChanged = true;
-						emptyValuesMap.erase(search);
-					}
-					else
-					{
-						// The original value is not an integer, this column cannot be nominal anymore
-						// Let's make it a nominal text.
-						changeToNominalText = true;
-						break;
-					}
-				}
-			}
+			// The original value is not an integer, this column cannot be nominal anymore
+			// Let's make it a nominal text.
+			setColumnType(Column::ColumnTypeNominalText);
+			return _resetEmptyValuesForNominalText(emptyValues, false);
 		}
-		else if (intValue != INT_MIN && isEmptyValue(intValue))
+
+		restored[emptyValues.row(i)] = intValue;
+	}
+
+	if (restored.size() > 0)
+	{
+		for (const auto &rowValue : restored)
 		{
-			// This value is now considered as empty
-			*ints = INT_MIN;
-			uniqueValues.erase(intValue);
-			hasChanged = true;
-			std::ostringstream strs;
-			strs << intValue;
-			emptyValuesMap.insert(make_pair(row, strs.str()));
+			AsInts[rowValue.first] = rowValue.second;
+			uniqueValues.insert(rowValue.second);
 		}
-		row++;
+
+		emptyValues.removeIf([&restored](int row, const string &) { return restored.count(row) > 0; });
+		hasChanged = true;
 	}
 
-	if (changeToNominalText)
+	// Only values of the labels can have become empty, so the rows only need to be walked when one of those did
+	set<int> nowEmpty;
+	for (int intValue : uniqueValues)
+		if (intValue != INT_MIN && isEmptyValue(intValue))
+			nowEmpty.insert(intValue);
+
+	if (nowEmpty.size() > 0)
 	{
-		setColumnType(Column::ColumnTypeNominalText);
-		emptyValuesMap.clear();
-		emptyValuesMap.insert(emptyValuesMapOrg.begin(), emptyValuesMapOrg.end());
-		hasChanged = _resetEmptyValuesForNominalText(emptyValuesMap, false);
+		ColumnEmptyValues	newEmptyValues;
+		int					row = 0;
+
+		for (Ints::iterator ints = AsInts.begin(); ints != AsInts.end(); ints++, row++)
+			if (*ints != INT_MIN && nowEmpty.count(*ints) > 0)
+			{
+				// This value is now considered as empty
+				newEmptyValues.set(row, std::to_string(*ints));
+				*ints = INT_MIN;
+			}
+
+		for (int intValue : nowEmpty)
+			uniqueValues.erase(intValue);
+
+		emptyValues.merge(newEmptyValues);
+		hasChanged = true;
 	}
-	else if (hasChanged)
+
+	if (hasChanged)
 		_labels.syncInts(uniqueValues);
 
 	return hasChanged;
 }
 
-bool Column::_resetEmptyValuesForScale(std::map<int, string> &emptyValuesMap)
+bool Column::_resetEmptyValuesForScale(ColumnEmptyValues &emptyValues)
 {
 	bool hasChanged = false;
-	int row = 0;
-	bool hasEmptyValues = !emptyValuesMap.empty();
+
+	// First check whether all the cells that aren't empty anymore are still numbers, before touching anything
+	std::map<int, double> restored; // row -> value
 	bool changeToNominalText = false;
-	Doubles::iterator doubles = AsDoubles.begin();
-	Doubles::iterator end = AsDoubles.end();
 
-	for (; doubles != end; doubles++)
+	for (size_t i = 0; i < emptyValues.size() && !changeToNominalText; i++)
 	{
-		double doubleValue = *doubles;
-		if (std::isnan(doubleValue) && hasEmptyValues)
-		{
-			auto search = emptyValuesMap.find(row);
-			if (search != emptyValuesMap.end())
-			{
-				string orgValue = search->second;
-				if (!isEmptyValue(orgValue))
-				{
-					// This value is not empty anymore
-					if (Utils::getDoubleValue(orgValue, doubleValue))
-					{
-						*doubles = doubleValue;
-						hasChanged = true;
-					}
-					else
-					{
-						changeToNominalText = true;
-						break;
-					}
-				}
-			}
-		}
-		else if (!std::isnan(doubleValue) && isEmptyValue(doubleValue))
-		{
-			// This value is now considered as empty
-			*doubles = NAN;
-			hasChanged = true;
-			std::ostringstream strs;
-			strs << doubleValue;
-			emptyValuesMap.insert(make_pair(row, strs.str()));
-		}
-		row++;
+		const string &orgValue = emptyValues.value(i);
+		if (emptyValues.row(i) >= int(_rowCount) || isEmptyValue(orgValue))
+			continue;
+
+		double doubleValue;
+		if (Utils::getDoubleValue(orgValue, doubleValue))	restored[emptyValues.row(i)] = doubleValue;
+		else												changeToNominalText = true;
 	}
 
 	if (changeToNominalText)
 	{
 		// Cannot use _resetEmptyValuesForNominalText since the AsInts are not set.
 		// So use setColumnAsNominalText
-		vector<string> values;
-		row = 0;
-		for (doubles = AsDoubles.begin(); doubles != end; doubles++)
+		vector<string>	values;
+		size_t			emptyIndex	= 0;
+		int				row			= 0;
+
+		values.reserve(_rowCount);
+
+		for (Doubles::iterator doubles = AsDoubles.begin(); doubles != AsDoubles.end(); doubles++, row++)
 		{
 			double doubleValue = *doubles;
-			if (std::isnan(doubleValue))
-			{
-				auto search = emptyValuesMap.find(row);
-				if (search != emptyValuesMap.end())
-				{
-					string orgValue = search->second;
-					values.push_back(orgValue);
-				}
-				else
-				{
-					values.push_back(Utils::emptyValue);
-				}
-			}
+
+			while (emptyIndex < emptyValues.size() && emptyValues.row(emptyIndex) < row)
+				emptyIndex++;
+
+			if (!std::isnan(doubleValue))
+				values.push_back(Utils::doubleToString(doubleValue));
+			else if (emptyIndex < emptyValues.size() && emptyValues.row(emptyIndex) == row)
+				values.push_back(emptyValues.value(emptyIndex));
 			else
+				values.push_back(Utils::emptyValue);
+		}
+
+		emptyValues = setColumnAsNominalText(values);
+		return true;
+	}
+
+	if (restored.size() > 0)
+	{
+		for (const auto &rowValue : restored)
+			AsDoubles[rowValue.first] = rowValue.second;
+
+		emptyValues.removeIf([&restored](int row, const string &) { return restored.count(row) > 0; });
+		hasChanged = true;
+	}
+
+	// Numbers can only have become empty when some of the empty values are numbers
+	if (Utils::getDoubleEmptyValues().size() > 0)
+	{
+		ColumnEmptyValues	newEmptyValues;
+		int					row = 0;
+
+		for (Doubles::iterator doubles = AsDoubles.begin(); doubles != AsDoubles.end(); doubles++, row++)
+		{
+			double doubleValue = *doubles;
+			if (!std::isnan(doubleValue) && isEmptyValue(doubleValue))
 			{
-				std::ostringstream strValue;
-				strValue << doubleValue;
-				values.push_back(strValue.str());
+				// This value is now considered as empty
+				*doubles = NAN;
+				newEmptyValues.set(row, Utils::doubleToString(doubleValue));
 			}
-			row++;
 		}
-		map<int, string> newEmptyValues = setColumnAsNominalText(values);
-		emptyValuesMap.clear();
-		emptyValuesMap.insert(newEmptyValues.begin(), newEmptyValues.end());
-		hasChanged = true;
+
+		if (!newEmptyValues.empty())
+		{
+			emptyValues.merge(newEmptyValues);
+			hasChanged = true;
+		}
 	}
 
 	return hasChanged;
 }
 
+bool Column::_resetEmptyValuesForNominalText(ColumnEmptyValues &emptyValues, bool tryToConvert)
+{
+	// This rebuilds the whole column anyway, so it simply works on a map of the empty values
+	std::map<int, string> emptyValuesMap = emptyValues.toMap();
+	bool hasChanged = _resetEmptyValuesForNominalText(emptyValuesMap, tryToConvert);
+	emptyValues = ColumnEmptyValues(emptyValuesMap);
+
+	return hasChanged;
+}
+
 bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesMap, bool tryToConvert)
 {
 	bool hasChanged = false;
@@ -400,27 +447,32 @@ bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesM
 		hasChanged = true;
 	}
 	else if (hasChanged)
-	{
-		map<int, string> newEmptyValues = setColumnAsNominalText(values);
-		emptyValuesMap.clear();
-		emptyValuesMap.insert(newEmptyValues.begin(), newEmptyValues.end());
-	}
+		emptyValuesMap = setColumnAsNominalText(values).toMap();
 
 	return hasChanged;
 
 }
 
-bool Column::resetEmptyValues(std::map<int, string> &emptyValuesMap)
+void Column::_changed()
+{
+	// Written by the desktop and the engines, so just like Labels::_changed the pid keeps their revisions apart
+	static std::atomic<uint64_t> counter(0);
+	_revision = (uint64_t(ProcessInfo::currentPID()) << 40) | ++counter;
+}
+
+bool Column::resetEmptyValues(ColumnEmptyValues &emptyValues)
 {
+	_changed();
+
 	if (_columnType == Column::ColumnTypeOrdinal || _columnType == Column::ColumnTypeNominal)
-		return _resetEmptyValuesForNominal(emptyValuesMap);
+		return _resetEmptyValuesForNominal(emptyValues);
 	else if (_columnType == Column::ColumnTypeScale)
-		return _resetEmptyValuesForScale(emptyValuesMap);
+		return _resetEmptyValuesForScale(emptyValues);
 	else
-		return _resetEmptyValuesForNominalText(emptyValuesMap);
+		return _resetEmptyValuesForNominalText(emptyValues);
 }
 
-void Column::setSharedMemory(managed_shared_memory *mem)
+void Column::setSharedMemory(SegmentManager *mem)
 {
 	_mem = mem;
 	_labels.setSharedMemory(mem);
@@ -583,6 +635,8 @@ bool Column::changeColumnType(Column::ColumnType newColumnType)
 	if (newColumnType == _columnType)
 		return true;
 
+	_changed();
+
 	bool success = true;
 	if (newColumnType == ColumnTypeScale)
 		success = _changeColumnToScale();
@@ -592,90 +646,118 @@ bool Column::changeColumnType(Column::ColumnType newColumnType)
 	return success;
 }
 
-bool Column::overwriteDataWithScale(std::vector<double> scalarData)
+bool Column::overwriteDataWithScale(const double * scalarData, size_t count)
 {
 	labels().clear();
 
-	size_t setVals = scalarData.size();
+	bool changedSomething = _overwriteValues(scalarData, count, static_cast<double>(std::nanf("")), &DataBlock::DataUnion::d);
 
-	if(scalarData.size() != rowCount())
-		scalarData.resize(rowCount());
-
-	for(size_t setThis = setVals; setThis<scalarData.size(); setThis++)
-		scalarData[setThis] = static_cast<double>(std::nanf(""));
+	setColumnType(Column::ColumnTypeScale);
 
-	return setColumnAsScale(scalarData);
+	return changedSomething;
 }
 
-bool Column::overwriteDataWithOrdinal(std::vector<int> ordinalData, std::map<int, std::string> levels)
+bool Column::overwriteDataWithOrdinal(const int * ordinalData, size_t count, const std::map<int, std::string> & levels)
 {
-	labels().clear();
-
-	size_t setVals = ordinalData.size();
+	return _overwriteDataWithInts(ordinalData, count, &levels, true);
+}
 
-	if(ordinalData.size() != rowCount())
-		ordinalData.resize(rowCount());
+bool Column::overwriteDataWithOrdinal(const int * ordinalData, size_t count)
+{
+	return _overwriteDataWithInts(ordinalData, count, nullptr, true);
+}
 
-	for(size_t setThis = setVals; setThis<ordinalData.size(); setThis++)
-		ordinalData[setThis] = INT_MIN;
+bool Column::overwriteDataWithNominal(const int * nominalData, size_t count, const std::map<int, std::string> & levels)
+{
+	return _overwriteDataWithInts(nominalData, count, &levels, false);
+}
 
-	return setColumnAsNominalOrOrdinal(ordinalData, levels, true);
+bool Column::overwriteDataWithNominal(const int * nominalData, size_t count)
+{
+	return _overwriteDataWithInts(nominalData, count, nullptr, false);
 }
 
-bool Column::overwriteDataWithOrdinal(std::vector<int> ordinalData)
+bool Column::overwriteDataWithNominal(const int * codes, size_t count, const std::vector<std::string> & distinctValues)
 {
 	labels().clear();
 
-	size_t setVals = ordinalData.size();
-
-	if(ordinalData.size() != rowCount())
-		ordinalData.resize(rowCount());
+	count = std::min(count, _rowCount);
 
-	for(size_t setThis = setVals; setThis<ordinalData.size(); setThis++)
-		ordinalData[setThis] = INT_MIN;
+	// The same text can come in more than once (R keeps strings with a different encoding mark apart), so merge those before they become labels
+	StringDictionary					dictionary(distinctValues.size());
+	std::vector<int>					merged;
+	std::vector<int>					remapped;
+	std::vector<const std::string *>	distinct;
 
-	return setColumnAsNominalOrOrdinal(ordinalData, true);
-}
+	merged.reserve(distinctValues.size());
+	for(const std::string & value : distinctValues)
+		merged.push_back(dictionary.encode(value));
 
-bool Column::overwriteDataWithNominal(std::vector<int> nominalData, std::map<int, std::string> levels)
-{
-	labels().clear();
+	for(size_t code = 0; code < dictionary.size(); code++)
+		distinct.push_back(&dictionary[code]);
 
-	size_t setVals = nominalData.size();
+	if(distinct.size() < distinctValues.size())
+	{
+		remapped.reserve(count);
+		for(size_t row = 0; row < count; row++)
+			remapped.push_back(merged[codes[row]]);
 
-	if(nominalData.size() != rowCount())
-		nominalData.resize(rowCount());
+		codes = remapped.data();
+	}
 
-	for(size_t setThis = setVals; setThis<nominalData.size(); setThis++)
-		nominalData[setThis] = INT_MIN;
+	bool changedSomething;
+	_setColumnAsNominalText(codes, count, distinct, std::map<std::string, std::string>(), &changedSomething);
 
-	return setColumnAsNominalOrOrdinal(nominalData, levels, false);
+	return changedSomething;
 }
 
-bool Column::overwriteDataWithNominal(std::vector<int> nominalData)
+bool Column::_overwriteDataWithInts(const int * values, size_t count, const std::map<int, std::string> * levels, bool is_ordinal)
 {
 	labels().clear();
 
-	size_t setVals = nominalData.size();
+	bool labelChanged;
+
+	if(levels != nullptr)
+	{
+		std::map<int, std::string> levelsToSync(*levels);
+		labelChanged = _labels.syncInts(levelsToSync);
+	}
+	else
+	{
+		std::set<int> uniqueValues(values, values + count);
+		uniqueValues.erase(INT_MIN);
+		labelChanged = _labels.syncInts(uniqueValues);
+	}
 
-	if(nominalData.size() != rowCount())
-		nominalData.resize(rowCount());
+	bool dataChanged = _overwriteValues(values, count, INT_MIN, &DataBlock::DataUnion::i);
 
-	for(size_t setThis = setVals; setThis<nominalData.size(); setThis++)
-		nominalData[setThis] = INT_MIN;
+	setColumnType(is_ordinal ? Column::ColumnTypeOrdinal : Column::ColumnTypeNominal);
 
-	return setColumnAsNominalOrOrdinal(nominalData, false);
+	return labelChanged || dataChanged;
 }
 
-bool Column::overwriteDataWithNominal(std::vector<std::string> nominalData)
+template<typename T> bool Column::_overwriteValues(const T * values, size_t count, T missing, T DataBlock::DataUnion::* member)
 {
-	labels().clear();
+	//Walks the blocks directly, rows past count become missing and values past the rows of the column are ignored.
+	bool	changedSomething	= false;
+	size_t	row					= 0;
 
-	if(nominalData.size() != rowCount())
-		nominalData.resize(rowCount());
+	_changed();
 
-	bool changedSomething;
-	setColumnAsNominalText(nominalData, &changedSomething);
+	for(BlockMap::iterator itr = _blocks.begin(); itr != _blocks.end() && row < _rowCount; itr++)
+	{
+		DataBlock * block = itr->second.get();
+
+		for(int i=0; i<block->rowCount() && row < _rowCount; i++, row++)
+		{
+			T value = row < count ? values[row] : missing;
+
+			if(block->Data[i].*member != value)
+				changedSomething = true;
+
+			block->Data[i].*member = value;
+		}
+	}
 
 	return changedSomething;
 }
@@ -687,10 +769,10 @@ void Column::setDefaultValues(Column::ColumnType columnType)
 
 	switch(columnType)
 	{
-	case ColumnTypeScale:		overwriteDataWithScale(std::vector<double>(rowCount(), static_cast<double>(std::nanf(""))));	break;
-	case ColumnTypeOrdinal:		overwriteDataWithOrdinal(std::vector<int>(rowCount(), INT_MIN));								break;
-	case ColumnTypeNominal:		overwriteDataWithNominal(std::vector<int>(rowCount(), INT_MIN));								break;
-	case ColumnTypeNominalText:	overwriteDataWithNominal(std::vector<std::string>(rowCount()));									break;
+	case ColumnTypeScale:		overwriteDataWithScale(nullptr, 0);								break;
+	case ColumnTypeOrdinal:		overwriteDataWithOrdinal(nullptr, 0);							break;
+	case ColumnTypeNominal:		overwriteDataWithNominal(nullptr, 0);							break;
+	case ColumnTypeNominalText:	overwriteDataWithNominal(nullptr, 0, std::vector<std::string>());	break;
 	case ColumnTypeUnknown:		throw std::runtime_error("Trying to set default values of a column with unknown column type...");
 	}
 	_labels.clear();
@@ -777,53 +859,78 @@ bool Column::setColumnAsScale(const std::vector<double> &values)
 	return changedSomething;
 }
 
-std::map<int, std::string> Column::setColumnAsNominalText(const std::vector<std::string> &values, bool * changedSomething)
+ColumnEmptyValues Column::setColumnAsNominalText(const std::vector<std::string> &values, bool * changedSomething)
 {
 	return setColumnAsNominalText(values, std::map<std::string, std::string>(), changedSomething);
 }
 
-std::map<int, std::string> Column::setColumnAsNominalText(const std::vector<std::string> &values, const std::map<std::string, std::string>&labels, bool * changedSomething)
+ColumnEmptyValues Column::setColumnAsNominalText(const std::vector<std::string> &values, const std::map<std::string, std::string>&labels, bool * changedSomething)
+{
+	// Dictionary-encode the values in one pass, so that everything else only needs to be done once per distinct value instead of once per row
+	StringDictionary					dictionary(std::min(values.size(), size_t(1024)));
+	std::vector<int>					codes;
+	std::vector<const std::string *>	distinct;
+
+	codes.reserve(values.size());
+	for(const std::string &value : values)
+		codes.push_back(dictionary.encode(value));
+
+	for(size_t code = 0; code < dictionary.size(); code++)
+		distinct.push_back(&dictionary[code]);
+
+	return _setColumnAsNominalText(codes.data(), codes.size(), distinct, labels, changedSomething);
+}
+
+ColumnEmptyValues Column::_setColumnAsNominalText(const int * codes, size_t count, const std::vector<const std::string *> &distinct, const std::map<std::string, std::string> &labels, bool * changedSomething)
 {
 	if(changedSomething != nullptr)
 		*changedSomething = false;
 
-	std::map<int, std::string>	emptyValuesMap;
-	std::set<std::string>		cases(values.begin(), values.end());
-	std::vector<std::string>	sortedCases(cases.begin(), cases.end());
+	ColumnEmptyValues			emptyValues;
+	std::vector<std::string>	sortedCases;
+	std::vector<bool>			codeIsEmpty(distinct.size());
+
+	for(size_t code = 0; code < distinct.size(); code++)
+	{
+		codeIsEmpty[code] = isEmptyValue(*distinct[code]);
+
+		if(!codeIsEmpty[code])
+			sortedCases.push_back(*distinct[code]);
+	}
 
 	std::sort(sortedCases.begin(), sortedCases.end());
 
-	sortedCases.erase(std::remove_if(sortedCases.begin(),	sortedCases.end(), [](std::string x){	return isEmptyValue(x);}), sortedCases.end());
+	std::map<std::string, int>	map = _labels.syncStrings(sortedCases, labels, changedSomething);
+	std::vector<int>			codeToKey(distinct.size(), INT_MIN);
+
+	for(size_t code = 0; code < distinct.size(); code++)
+		if(!codeIsEmpty[code])
+		{
+			auto key = map.find(*distinct[code]);
+
+			if (key == map.end())
+				throw std::runtime_error("Error when reading column " + name() + ": cannot convert it to Nominal Text");
 
-	std::map<std::string, int> map = _labels.syncStrings(sortedCases, labels, changedSomething);
+			codeToKey[code] = key->second;
+		}
 
 	auto	intInputItr = AsInts.begin();
 	int		nb_values	= 0;
 
-	for(const std::string &value : values)
+	for(size_t row = 0; row < count; row++)
 	{
+		int code = codes[row];
+
 		if(intInputItr == AsInts.end())
 			throw std::runtime_error("Column::setColumnAsNominalText ran out of Ints in assigning..");
 
-		if (isEmptyValue(value))
-		{
-			if(changedSomething != nullptr && *intInputItr != INT_MIN)
-				*changedSomething = true;
+		if(changedSomething != nullptr && *intInputItr != codeToKey[code])
+			*changedSomething = true;
 
-			*intInputItr = INT_MIN;
-			if (!value.empty())
-				emptyValuesMap.insert(make_pair(nb_values, value));
-		}
-		else
-		{
-			if (map.find(value) == map.end())
-				throw std::runtime_error("Error when reading column " + name() + ": cannot convert it to Nominal Text");
-			
-			if(changedSomething != nullptr && *intInputItr != map[value])
-				*changedSomething = true;
+		*intInputItr = codeToKey[code];
 
-			*intInputItr = map[value];
-		}
+		if (codeIsEmpty[code] && !distinct[code]->empty())
+			emptyValues.set(nb_values, *distinct[code]);
 
 		intInputItr++;
 		nb_values++;
@@ -841,7 +948,7 @@ std::map<int, std::string> Column::setColumnAsNominalText(const std::vector<std:
 
 	setColumnType(Column::ColumnTypeNominalText);
 
-	return emptyValuesMap;
+	return emptyValues;
 }
 
 string Column::_getLabelFromKey(int key) const
@@ -870,7 +977,7 @@ int Column::id() const
 
 void Column::setName(string name)
 {
-	_name = String(name.begin(), name.end(), _mem->get_segment_manager());
+	_name = String(name.begin(), name.end(), _mem);
 }
 
 void Column::setValue(int row, int value)
@@ -888,6 +995,7 @@ void Column::setValue(int row, int value)
 
 	int blockIndex = row - blockId + DataBlock::capacity();
 	block->Data[blockIndex].i = value;
+	_changed();
 }
 
 void Column::setValue(int row, double value)
@@ -905,6 +1013,115 @@ void Column::setValue(int row, double value)
 
 	int blockIndex = row - blockId + DataBlock::capacity();
 	block->Data[blockIndex].d = value;
+	_changed();
+}
+
+void Column::setValues(int firstRow, const int * values, int count)
+{
+	_setValues(firstRow, values, count, &DataBlock::DataUnion::i);
+}
+
+void Column::setValues(int firstRow, const double * values, int count)
+{
+	_setValues(firstRow, values, count, &DataBlock::DataUnion::d);
+}
+
+template<typename T> void Column::_setValues(int firstRow, const T * values, int count, T DataBlock::DataUnion::* member)
+{
+	//Same lookup as setValue, but only for the first row, after that the blocks are simply walked through.
+	int row = firstRow;
+
+	_changed();
+
+	for(BlockMap::iterator itr = _blocks.upper_bound(row); itr != _blocks.end() && count > 0; itr++)
+	{
+		DataBlock	*	block		= itr->second.get();
+		int				blockIndex	= row - int(itr->first) + DataBlock::capacity(),
+						toCopy		= std::min(count, block->rowCount() - blockIndex);
+
+		for(int i=0; i<toCopy; i++)
+			block->Data[blockIndex + i].*member = values[i];
+
+		values	+= toCopy;
+		row		+= toCopy;
+		count	-= toCopy;
+	}
+}
+
+int Column::copyValues(int * out, int maxCount, const std::vector<uint64_t> * rowMask, int firstRow) const
+{
+	return _copyValues(out, maxCount, rowMask, firstRow, &DataBlock::DataUnion::i);
+}
+
+int Column::copyValues(double * out, int maxCount, const std::vector<uint64_t> * rowMask, int firstRow) const
+{
+	return _copyValues(out, maxCount, rowMask, firstRow, &DataBlock::DataUnion::d);
+}
+
+template<typename T> int Column::_copyValues(T * out, int maxCount, const std::vector<uint64_t> * rowMask, int firstRow, T DataBlock::DataUnion::* member) const
+{
+	//Walks the blocks instead of the rows, and per 64 rows of the mask: a full word is a plain copy, an empty one is skipped and the rest is compressed without branching.
+	//Rows past the end of the mask count as not set.
+	int copied	= 0,
+		row		= 0;
+	int maskRows = rowMask == nullptr ? INT_MAX : int(rowMask->size() * 64);
+
+	for(BlockMap::const_iterator itr = _blocks.begin(); itr != _blocks.end() && copied < maxCount && row < maskRows; itr++)
+	{
+		const DataBlock::DataUnion	*	data		= itr->second->Data;
+		int								blockRows	= std::min(itr->second->_rowCount, maskRows - row);
+
+		if(row + blockRows <= firstRow)
+		{
+			row += blockRows;
+			continue;
+		}
+
+		for(int i=std::max(0, firstRow - row); i<blockRows && copied < maxCount;)
+		{
+			int		r		= row + i,
+					inWord	= std::min(64 - (r & 63), blockRows - i); //Block boundaries don't line up with the words of the mask
+			uint64_t word	= rowMask == nullptr ? ~uint64_t(0) : (*rowMask)[r >> 6] >> (r & 63);
+
+			if(inWord < 64)
+				word &= (uint64_t(1) << inWord) - 1;
+
+			if(word == 0)
+			{
+				i += inWord;
+				continue;
+			}
+
+			const DataBlock::DataUnion * from = data + i;
+
+			if(copied + inWord <= maxCount)
+			{
+				if(word == (inWord == 64 ? ~uint64_t(0) : (uint64_t(1) << inWord) - 1))
+					for(int b=0; b<inWord; b++)
+						out[copied++] = from[b].*member;
+				else
+				{
+					int n = copied;
+					for(int b=0; b<inWord; b++)
+					{
+						out[n]	= from[b].*member;	//Always written, only kept when the bit is set. Stays within out because copied + inWord <= maxCount
+						n		+= (word >> b) & 1;
+					}
+					copied = n;
+				}
+			}
+			else
+				for(int b=0; b<inWord && copied < maxCount; b++)
+					if((word >> b) & 1)
+						out[copied++] = from[b].*member;
+
+			i += inWord;
+		}
+
+		row += blockRows;
+	}
+
+	return copied;
 }
 
 bool Column::isValueEqual(int row, double value)
@@ -1019,9 +1236,7 @@ string Column::_getScaleValue(int row)
 	}
 	else
 	{
-		stringstream s;
-		s << v;
-		return s.str();
+		return Utils::doubleToString(v);
 	}
 }
 
@@ -1069,11 +1284,47 @@ string Column::operator [](int row)
 	return result;
 }
 
+std::vector<string> Column::displayValues(int firstRow, int count)
+{
+	std::vector<string> values;
+
+	int lastRow = std::min(firstRow + count, int(_rowCount));
+	if (firstRow >= lastRow)
+		return values;
+
+	values.reserve(lastRow - firstRow);
+
+	if (_columnType == Column::ColumnTypeScale)
+	{
+		for (int row = firstRow; row < lastRow; row++)
+			values.push_back(_getScaleValue(row));
+
+		return values;
+	}
+
+	// getLabelObjectFromKey walks through all labels, so do that once for the whole range
+	std::map<int, string> keyToLabel;
+	for (const Label &label : _labels)
+		keyToLabel.insert(make_pair(label.value(), label.text()));
+
+	for (int row = firstRow; row < lastRow; row++)
+	{
+		int		key		= AsInts[row];
+		auto	label	= keyToLabel.find(key);
+
+		values.push_back(label != keyToLabel.end() && key != INT_MIN ? label->second : _getLabelFromKey(key));
+	}
+
+	return values;
+}
+
 void Column::append(int rows)
 {
 	if (rows == 0)
 		return;
 
+	_changed();
+
 	BlockMap::reverse_iterator itr = _blocks.rbegin();
 
 	if (itr == _blocks.rend()) // no blocks
@@ -1134,6 +1385,8 @@ void Column::truncate(int rows)
 {
 	if (rows <= 0) return;
 
+	_changed();
+
 	BlockMap::reverse_iterator itr = _blocks.rbegin();
 	DataBlock *block = itr->second.get();
 
@@ -1197,6 +1450,7 @@ Column::ColumnType Column::columnTypeFromString(std::string type)
 void Column::setColumnType(Column::ColumnType columnType)
 {
 	_columnType = columnType;
+	_changed();
 }
 
 void Column::_setRowCount(int rowCount)
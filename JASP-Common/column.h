@@ -25,6 +25,7 @@
 #include <boost/container/string.hpp>
 #include <boost/container/vector.hpp>
 
+#include "columnemptyvalues.h"
 #include "datablock.h"
 #include "labels.h"
 
@@ -39,14 +40,14 @@ class Column
 	friend class boost::iterator_core_access;
 
 	typedef unsigned long long ull;
-	typedef boost::interprocess::allocator<boost::interprocess::offset_ptr<DataBlock>, boost::interprocess::managed_shared_memory::segment_manager> BlockAllocator;
+	typedef boost::interprocess::allocator<boost::interprocess::offset_ptr<DataBlock>, SegmentManager> BlockAllocator;
 	typedef boost::container::map<ull, boost::interprocess::offset_ptr<DataBlock>, BlockAllocator>::value_type BlockEntry;
-	typedef boost::interprocess::allocator<BlockEntry, boost::interprocess::managed_shared_memory::segment_manager> BlockEntryAllocator;
+	typedef boost::interprocess::allocator<BlockEntry, SegmentManager> BlockEntryAllocator;
 	typedef boost::container::map<ull, boost::interprocess::offset_ptr<DataBlock>, std::less<ull>, BlockEntryAllocator> BlockMap;
 
-	typedef boost::interprocess::allocator<char, boost::interprocess::managed_shared_memory::segment_manager> CharAllocator;
+	typedef boost::interprocess::allocator<char, SegmentManager> CharAllocator;
 	typedef boost::container::basic_string<char, std::char_traits<char>, CharAllocator> String;
-	typedef boost::interprocess::allocator<String, boost::interprocess::managed_shared_memory::segment_manager> StringAllocator;
+	typedef boost::interprocess::allocator<String, SegmentManager> StringAllocator;
 
 public:
 	///ColumnType is set up to be used as bitflags in places such as assignedVariablesModel and such
@@ -55,15 +56,16 @@ public:
 	static bool isEmptyValue(const std::string& val);
 	static bool isEmptyValue(const double& val);
 
-	bool resetEmptyValues(std::map<int, std::string>& emptyValuesMap);
+	bool resetEmptyValues(ColumnEmptyValues& emptyValues);
 
 
-	bool overwriteDataWithScale(std::vector<double> scalarData);
-	bool overwriteDataWithOrdinal(std::vector<int> ordinalData, std::map<int, std::string> levels);
-	bool overwriteDataWithNominal(std::vector<int> nominalData, std::map<int, std::string> levels);
-	bool overwriteDataWithOrdinal(std::vector<int> ordinalData);
-	bool overwriteDataWithNominal(std::vector<int> nominalData);
-	bool overwriteDataWithNominal(std::vector<std::string> nominalData);
+	// These write count values straight into the blocks, rows past count become missing
+	bool overwriteDataWithScale(	const double	* scalarData,	size_t count);
+	bool overwriteDataWithOrdinal(	const int		* ordinalData,	size_t count, const std::map<int, std::string> & levels);
+	bool overwriteDataWithNominal(	const int		* nominalData,	size_t count, const std::map<int, std::string> & levels);
+	bool overwriteDataWithOrdinal(	const int		* ordinalData,	size_t count);
+	bool overwriteDataWithNominal(	const int		* nominalData,	size_t count);
+	bool overwriteDataWithNominal(	const int		* codes,		size_t count, const std::vector<std::string> & distinctValues); ///< Nominal text, already dictionary-encoded: codes index distinctValues, which may contain the same string more than once
 	void setDefaultValues(ColumnType columnType = ColumnTypeUnknown);
 
 	typedef struct IntsStruct
@@ -139,12 +141,12 @@ public:
 
 	} Doubles;
 
-	Column(boost::interprocess::managed_shared_memory *mem)  : _mem(mem), _name(mem->get_segment_manager()), _columnType(Column::ColumnTypeNominal), _rowCount(0), _blocks(std::less<ull>(), mem->get_segment_manager()), _labels(mem)
+	Column(SegmentManager *mem)  : _mem(mem), _name(mem), _columnType(Column::ColumnTypeNominal), _rowCount(0), _blocks(std::less<ull>(), mem), _labels(mem)
 	{
 		_id = ++count;
 	}
 
-	Column(const Column& col) : _mem(col._mem), _name(col._name), _columnType(col._columnType), _rowCount(col._rowCount), _blocks(col._blocks), _labels(col._labels)
+	Column(const Column& col) : _mem(col._mem), _name(col._name), _columnType(col._columnType), _rowCount(col._rowCount), _blocks(col._blocks), _labels(col._labels), _version(col._version), _revision(col._revision)
 	{
 		_id = ++count;
 	}
@@ -157,6 +159,10 @@ public:
 
 	void setValue(int row, int value);
 	void setValue(int row, double value);
+	void setValues(int firstRow, const int		* values, int count); ///< Copies count values straight into the blocks, much cheaper than calling setValue for every row.
+	void setValues(int firstRow, const double	* values, int count);
+	int  copyValues(int		* out, int maxCount, const std::vector<uint64_t> * rowMask = nullptr, int firstRow = 0) const; ///< Copies at most maxCount values, starting at firstRow, into out, only those of the rows whose bit is set in rowMask when given, and returns how many were copied.
+	int  copyValues(double	* out, int maxCount, const std::vector<uint64_t> * rowMask = nullptr, int firstRow = 0) const;
 
 	bool isValueEqual(int row, int value);
 	bool isValueEqual(int row, double value);
@@ -164,6 +170,7 @@ public:
 
 	std::string operator[](int row);
 	std::string getOriginalValue(int row);
+	std::vector<std::string> displayValues(int firstRow, int count); ///< What operator[] gives for count rows from firstRow on, but with the labels looked up once.
 
 	void append(int rows);
 	void truncate(int rows);
@@ -193,17 +200,18 @@ public:
 	bool changeColumnType(ColumnType newColumnType);
 
 	size_t rowCount() const { return _rowCount; }
+	uint64_t revision() const { return _revision; } ///< Changes whenever the values or the type do, the labels have their own Labels::revision
 
 	Labels& labels();
 
 	Column &operator=(const Column &columns);
 
-	void setSharedMemory(boost::interprocess::managed_shared_memory *mem);
+	void setSharedMemory(SegmentManager *mem);
 
 	bool						setColumnAsScale(const std::vector<double> &values);
 
-	std::map<int, std::string>	setColumnAsNominalText(const std::vector<std::string> &values,	const std::map<std::string, std::string> &labels, bool * changedSomething = NULL);
-	std::map<int, std::string>	setColumnAsNominalText(const std::vector<std::string> &values, bool * changedSomething = NULL);
+	ColumnEmptyValues			setColumnAsNominalText(const std::vector<std::string> &values,	const std::map<std::string, std::string> &labels, bool * changedSomething = NULL);
+	ColumnEmptyValues			setColumnAsNominalText(const std::vector<std::string> &values, bool * changedSomething = NULL);
 
 	bool						setColumnAsNominalOrOrdinal(const std::vector<int> &values,		const std::set<int> &uniqueValues,			bool is_ordinal = false);
 	bool						setColumnAsNominalOrOrdinal(const std::vector<int> &values,		std::map<int, std::string> &uniqueValues,	bool is_ordinal = false);
@@ -218,8 +226,10 @@ public:
 private:	
 
 	bool _setColumnAsNominalOrOrdinal(const std::vector<int> &values, bool is_ordinal = false);
+	bool _overwriteDataWithInts(const int * values, size_t count, const std::map<int, std::string> * levels, bool is_ordinal);
+	ColumnEmptyValues _setColumnAsNominalText(const int * codes, size_t count, const std::vector<const std::string *> &distinct, const std::map<std::string, std::string> &labels, bool * changedSomething);
 
-	boost::interprocess::managed_shared_memory *_mem;
+	SegmentManager *_mem;
 
 	String _name;
 	ColumnType _columnType;
@@ -231,15 +241,27 @@ private:
 	int _id;
 	static int count;
 
+	size_t _version = 0; ///< DataSet::dataVersion() the current contents were written in, see DataSet::preserveForSnapshots
+	uint64_t _revision = 0;
+
+	void _changed();
+
+	void _copyContentsFrom(const Column & other);
+	void _destroyBlocks(SegmentManager *mem);
+
 	void _setRowCount(int rowCount);
+	template<typename T> void _setValues(int firstRow, const T * values, int count, T DataBlock::DataUnion::* member);
+	template<typename T> bool _overwriteValues(const T * values, size_t count, T missing, T DataBlock::DataUnion::* member);
+	template<typename T> int  _copyValues(T * out, int maxCount, const std::vector<uint64_t> * rowMask, int firstRow, T DataBlock::DataUnion::* member) const;
 	std::string _getLabelFromKey(int key) const;
 	std::string _getScaleValue(int row);
 
 	void _convertVectorIntToDouble(std::vector<int> &intValues, std::vector<double> &doubleValues);
 
-	bool _resetEmptyValuesForNominal(std::map<int, std::string> &emptyValuesMap);
-	bool _resetEmptyValuesForScale(std::map<int, std::string> &emptyValuesMap);
-	bool _resetEmptyValuesForNominalText(std::map<int, std::string> &emptyValuesMap, bool tryToConvert = true);
+	bool _resetEmptyValuesForNominal(ColumnEmptyValues &emptyValues);
+	bool _resetEmptyValuesForScale(ColumnEmptyValues &emptyValues);
+	bool _resetEmptyValuesForNominalText(ColumnEmptyValues &emptyValues, bool tryToConvert = true);
+	bool _resetEmptyValuesForNominalText(std::map<int, std::string> &emptyValuesMap, bool tryToConvert);
 
 	bool _changeColumnToNominalOrOrdinal(ColumnType newColumnType);
 	bool _changeColumnToScale();
@@ -0,0 +1,205 @@
+#include "columnemptyvalues.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+ColumnEmptyValues::ColumnEmptyValues(const std::map<int, std::string> & emptyValuesMap)
+{
+	_rows.reserve(emptyValuesMap.size());
+	_ids.reserve(emptyValuesMap.size());
+
+	for (const auto & rowValue : emptyValuesMap)
+		set(rowValue.first, rowValue.second);
+}
+
+void ColumnEmptyValues::clear()
+{
+	_rows.clear();
+	_ids.clear();
+	_strings.clear();
+	_stringIds.clear();
+}
+
+ColumnEmptyValues::StringId ColumnEmptyValues::intern(const std::string & value)
+{
+	auto found = _stringIds.find(value);
+
+	if (found != _stringIds.end())
+		return found->second;
+
+	StringId id = StringId(_strings.size());
+	_strings.push_back(value);
+	_stringIds[value] = id;
+
+	return id;
+}
+
+size_t ColumnEmptyValues::lowerBound(int row) const
+{
+	return std::lower_bound(_rows.begin(), _rows.end(), row) - _rows.begin();
+}
+
+void ColumnEmptyValues::set(int row, const std::string & value)
+{
+	StringId id = intern(value);
+
+	if (_rows.empty() || _rows.back() < row)
+	{
+		_rows.push_back(row);
+		_ids.push_back(id);
+		return;
+	}
+
+	size_t index = lowerBound(row);
+
+	if (_rows[index] == row)
+		_ids[index] = id;
+	else
+	{
+		_rows.insert(_rows.begin() + index, row);
+		_ids.insert(_ids.begin() + index, id);
+	}
+}
+
+void ColumnEmptyValues::merge(const ColumnEmptyValues & other)
+{
+	if (other.empty())
+		return;
+
+	std::vector<int>		rows;
+	std::vector<StringId>	ids;
+
+	rows.reserve(_rows.size() + other._rows.size());
+	ids.reserve(_rows.size() + other._rows.size());
+
+	size_t mine = 0, theirs = 0;
+
+	while (mine < _rows.size() || theirs < other._rows.size())
+	{
+		if (theirs == other._rows.size() || (mine < _rows.size() && _rows[mine] <= other._rows[theirs]))
+		{
+			if (theirs < other._rows.size() && _rows[mine] == other._rows[theirs])
+				theirs++;
+
+			rows.push_back(_rows[mine]);
+			ids.push_back(_ids[mine]);
+			mine++;
+		}
+		else
+		{
+			rows.push_back(other._rows[theirs]);
+			ids.push_back(intern(other.value(theirs)));
+			theirs++;
+		}
+	}
+
+	_rows.swap(rows);
+	_ids.swap(ids);
+}
+
+const std::string * ColumnEmptyValues::find(int row) const
+{
+	size_t index = lowerBound(row);
+
+	return index < _rows.size() && _rows[index] == row ? &_strings[_ids[index]] : nullptr;
+}
+
+std::map<int, std::string> ColumnEmptyValues::toMap() const
+{
+	std::map<int, std::string> emptyValuesMap;
+
+	for (size_t i = 0; i < _rows.size(); i++)
+		emptyValuesMap.insert(emptyValuesMap.end(), std::make_pair(_rows[i], value(i)));
+
+	return emptyValuesMap;
+}
+
+namespace
+{
+	void appendUInt32(std::string & out, uint32_t value)
+	{
+		out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	uint32_t readUInt32(const char * data, size_t size, size_t & pos)
+	{
+		if (pos + sizeof(uint32_t) > size)
+			throw std::runtime_error("Empty values data ends too early.");
+
+		uint32_t value;
+		std::memcpy(&value, data + pos, sizeof(value));
+		pos += sizeof(value);
+
+		return value;
+	}
+}
+
+// Layout, all numbers as uint32: stringCount, then per string its length and bytes, then entryCount, entryCount rows and entryCount string ids.
+void ColumnEmptyValues::appendBinary(std::string & out) const
+{
+	std::vector<StringId>	used(_strings.size(), StringId(-1));
+	std::vector<StringId>	ids;
+	StringId				usedCount = 0;
+
+	ids.reserve(_ids.size());
+
+	for (StringId id : _ids)
+	{
+		if (used[id] == StringId(-1))
+			used[id] = usedCount++;
+		ids.push_back(used[id]);
+	}
+
+	std::vector<const std::string*> strings(usedCount);
+	for (size_t id = 0; id < _strings.size(); id++)
+		if (used[id] != StringId(-1))
+			strings[used[id]] = &_strings[id];
+
+	appendUInt32(out, usedCount);
+	for (const std::string * str : strings)
+	{
+		appendUInt32(out, uint32_t(str->size()));
+		out.append(*str);
+	}
+
+	appendUInt32(out, uint32_t(_rows.size()));
+	out.append(reinterpret_cast<const char*>(_rows.data()),	_rows.size()	* sizeof(int));
+	out.append(reinterpret_cast<const char*>(ids.data()),	ids.size()		* sizeof(StringId));
+}
+
+size_t ColumnEmptyValues::readBinary(const char * data, size_t size)
+{
+	clear();
+
+	size_t		pos			= 0;
+	uint32_t	stringCount	= readUInt32(data, size, pos);
+
+	for (uint32_t i = 0; i < stringCount; i++)
+	{
+		uint32_t length = readUInt32(data, size, pos);
+
+		if (pos + length > size)
+			throw std::runtime_error("Empty values data ends too early.");
+
+		_strings.push_back(std::string(data + pos, length));
+		_stringIds[_strings.back()] = StringId(i);
+		pos += length;
+	}
+
+	uint32_t entryCount = readUInt32(data, size, pos);
+
+	if (pos + size_t(entryCount) * (sizeof(int) + sizeof(StringId)) > size)
+		throw std::runtime_error("Empty values data ends too early.");
+
+	_rows.resize(entryCount);
+	_ids.resize(entryCount);
+
+	std::memcpy(_rows.data(),	data + pos, entryCount * sizeof(int));		pos += entryCount * sizeof(int);
+	std::memcpy(_ids.data(),	data + pos, entryCount * sizeof(StringId));	pos += entryCount * sizeof(StringId);
+
+	for (size_t i = 0; i < entryCount; i++)
+		if (_ids[i] >= stringCount || (i > 0 && _rows[i - 1] >= _rows[i]))
+			throw std::runtime_error("Empty values data has been corrupted.");
+
+	return pos;
+}
@@ -0,0 +1,61 @@
+#ifndef COLUMNEMPTYVALUES_H
+#define COLUMNEMPTYVALUES_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+
+///The original text of the cells in a column that are treated as missing, so that they can be restored when the missing values change.
+///Kept as a sorted array of rows with a parallel array of ids into a table of interned strings, sparse data tends to have millions of these cells but only a handful of different texts.
+class ColumnEmptyValues
+{
+public:
+	typedef uint32_t StringId;
+
+						ColumnEmptyValues() {}
+						ColumnEmptyValues(const std::map<int, std::string> & emptyValuesMap);
+
+	bool				empty()						const	{ return _rows.empty();				}
+	size_t				size()						const	{ return _rows.size();				}
+	int					row(size_t index)			const	{ return _rows[index];				}
+	const std::string &	value(size_t index)			const	{ return _strings[_ids[index]];		}
+
+	void				clear();
+	void				set(int row, const std::string & value);	///< Appending in order of rows is constant time, anything else has to shift the arrays.
+	void				merge(const ColumnEmptyValues & other);		///< Adds all of other in a single pass, rows already here keep their value.
+	const std::string *	find(int row)				const;			///< nullptr if row has no original text.
+	size_t				lowerBound(int row)			const;			///< Index of the first entry with a row of at least row.
+
+	template<typename Predicate> void removeIf(Predicate remove) ///< remove is called with (row, value) for every entry.
+	{
+		size_t kept = 0;
+
+		for (size_t i = 0; i < _rows.size(); i++)
+			if (!remove(_rows[i], _strings[_ids[i]]))
+			{
+				_rows[kept]	= _rows[i];
+				_ids[kept]	= _ids[i];
+				kept++;
+			}
+
+		_rows.resize(kept);
+		_ids.resize(kept);
+	}
+
+	std::map<int, std::string>	toMap()			const;
+
+	void				appendBinary(std::string & out)						const;	///< Only writes the strings that are still in use.
+	size_t				readBinary(const char * data, size_t size);					///< Returns how many bytes were read, throws when data is corrupt.
+
+private:
+	StringId			intern(const std::string & value);
+
+	std::vector<int>							_rows;
+	std::vector<StringId>						_ids;
+	std::vector<std::string>					_strings;
+	std::unordered_map<std::string, StringId>	_stringIds;
+};
+
+#endif // COLUMNEMPTYVALUES_H
@@ -90,7 +90,7 @@ void Columns::removeColumn(std::string name)
 }
 
 
-void Columns::setSharedMemory(boost::interprocess::managed_shared_memory *mem)
+void Columns::setSharedMemory(SegmentManager *mem)
 {
 	_mem = mem;
 
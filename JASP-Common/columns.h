@@ -33,7 +33,7 @@ struct columnNotFound : public std::runtime_error
 	const char* what() const noexcept override;
 };
 
-typedef boost::interprocess::allocator<Column, boost::interprocess::managed_shared_memory::segment_manager> ColumnAllocator;
+typedef boost::interprocess::allocator<Column, SegmentManager> ColumnAllocator;
 typedef boost::container::vector<Column, ColumnAllocator> ColumnVector;
 
 class Columns
@@ -43,7 +43,7 @@ class Columns
 
 public:
 
-	Columns(boost::interprocess::managed_shared_memory *mem) : _columnStore(mem->get_segment_manager()), _mem(mem) { }
+	Columns(SegmentManager *mem) : _columnStore(mem), _mem(mem) { }
 
 	size_t findIndexByName(std::string name) const;
 			Column& at(size_t index)		{ return _columnStore.at(index); }
@@ -76,9 +76,9 @@ public:
 	Column * createColumn(std::string name);
 
 private:
-	void setSharedMemory(boost::interprocess::managed_shared_memory *mem);
+	void setSharedMemory(SegmentManager *mem);
 
-	boost::interprocess::managed_shared_memory *_mem;
+	SegmentManager *_mem;
 
 
 	void setRowCount(size_t rowCount);
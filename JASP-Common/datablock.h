@@ -31,7 +31,7 @@ public:
 
 	int _rowCount;
 
-	union { double d; int i; } Data[BLOCK_SIZE];
+	union DataUnion { double d; int i; } Data[BLOCK_SIZE];
 
 	int rowCount();
 	static int capacity();
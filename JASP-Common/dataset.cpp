@@ -17,10 +17,17 @@
 
 #include "dataset.h"
 #include "log.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <new>
+#include <atomic>
+#include <future>
+#include <thread>
 
 using namespace std;
 /* DataSet is implemented as a set of columns */
 
+const size_t DataSet::maxSnapshotPins, DataSet::desktopSlot, DataSet::snapshotLockWaitMs; //boost::posix_time::milliseconds takes them by reference, so they need a definition
+
 
 void DataSet::setRowCount(size_t newRowCount)
 {
@@ -43,12 +50,12 @@ void DataSet::setColumnCount(size_t newColumnCount)
 	}
 }
 
-void DataSet::setSharedMemory(boost::interprocess::managed_shared_memory *mem)
+void DataSet::setSharedMemory(SegmentManager *mem)
 {
 	_mem = mem;
 	_columns.setSharedMemory(mem);
 
-	_filterVector = BoolVector(mem->get_segment_manager());
+	_filterVector = BoolVector(mem);
 	for(size_t i=0; i<maxRowCount(); i++)
 		_filterVector.push_back(true);
 }
@@ -75,27 +82,69 @@ string DataSet::toString()
 	return ss.str();
 }
 
-vector<string> DataSet::resetEmptyValues(map<string, map<int, string> > emptyValuesPerColumnMap)
+vector<string> DataSet::resetEmptyValues(emptyValsType & emptyValuesPerColumnMap)
 {
-	vector<string> colChanged;
-	for (Columns::iterator col_it = _columns.begin(); col_it != _columns.end(); ++col_it)
+	const size_t				parallelFromCells	= 1 << 20,
+								columnCount			= _columns.columnCount();
+	vector<ColumnEmptyValues*>	emptyValues(columnCount);
+	vector<char>				changed(columnCount, 0);
+
+	// Every column gets its own entry before any thread starts, so the map itself isn't changed while they run
+	for (size_t c = 0; c < columnCount; c++)
+		emptyValues[c] = &emptyValuesPerColumnMap[_columns.at(c).name()];
+
+	auto resetColumn = [&](size_t c) { changed[c] = _columns.at(c).resetEmptyValues(*emptyValues[c]); };
+
+	size_t threads = std::min(columnCount, size_t(std::max(1u, std::thread::hardware_concurrency())));
+
+	if (threads <= 1 || rowCount() * columnCount < parallelFromCells)
+		for (size_t c = 0; c < columnCount; c++)
+			resetColumn(c);
+	else
 	{
-		Column& col = *col_it;
-		map<string, map<int, string> >::iterator it = emptyValuesPerColumnMap.find(col.name());
-		map<int, string> emptyValuesMap;
-		if (it != emptyValuesPerColumnMap.end())
-			emptyValuesMap = it->second;
-
-		if (col.resetEmptyValues(emptyValuesMap))
-			colChanged.push_back(col.name());
-		emptyValuesPerColumnMap[col.name()] = emptyValuesMap;
+		// The columns don't depend on each other, so each thread keeps taking the next column that nobody started on yet
+		std::atomic<size_t>				nextColumn(0);
+		std::vector<std::future<void>>	workers;
+
+		for (size_t t = 0; t < threads; t++)
+			workers.push_back(std::async(std::launch::async, [&]()
+			{
+				for (size_t c = nextColumn++; c < columnCount; c = nextColumn++)
+					resetColumn(c);
+			}));
+
+		for (std::future<void> & worker : workers)
+			worker.get(); // Rethrows whatever went wrong, like the bad_alloc that makes MainWindow enlarge the shared memory
 	}
 
+	vector<string> colChanged;
+	for (size_t c = 0; c < columnCount; c++)
+		if (changed[c])
+			colChanged.push_back(_columns.at(c).name());
+
 	return colChanged;
 }
 
+size_t DataSet::estimateSharedMemorySize(size_t columnCount, size_t rowCount, size_t labelCount)
+{
+	// Every column keeps its rows in DataBlocks, each of which also costs a node in the column's map of blocks
+	const size_t	blockOverhead	= 64,
+					labelOverhead	= 16,
+					fixedOverhead	= 1024 * 1024;
+
+	size_t	blocksPerColumn	= (rowCount + DataBlock::capacity() - 1) / DataBlock::capacity(),
+			bytes			= fixedOverhead
+							+ columnCount	* (sizeof(Column) + blocksPerColumn * (sizeof(DataBlock) + blockOverhead))
+							+ labelCount	* (sizeof(Label) + labelOverhead)
+							+ rowCount		* sizeof(bool); // the filter
+
+	return bytes + bytes / 4; // The allocator doesn't get to use all of it
+}
+
 bool DataSet::setFilterVector(std::vector<bool> filterResult)
 {
+	_preserveFilterForSnapshots();
+
 	bool changed = false;
 
 	_filteredRowCount = 0;
@@ -138,3 +187,204 @@ void DataSet::setSynchingData(bool newVal)
 
 	_synchingData = newVal;
 }
+
+DataSet::SnapshotLock::SnapshotLock(DataSet & dataSet, size_t slot) : _dataSet(dataSet), _owns(true)
+{
+	if (slot == desktopSlot)
+	{
+		_owns = dataSet._snapshotMutex.timed_lock(boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(snapshotLockWaitMs));
+
+		if (!_owns)
+			Log::log() << "DataSet::SnapshotLock gave up waiting for engine " << (dataSet._snapshotLockHolder - 1) << " to release the snapshots." << std::endl;
+	}
+	else
+	{
+		dataSet._snapshotMutex.lock();
+		dataSet._snapshotLockHolder = slot + 1;
+	}
+}
+
+DataSet::SnapshotLock::~SnapshotLock()
+{
+	if (!_owns)
+		return;
+
+	_dataSet._snapshotLockHolder = 0;
+	_dataSet._snapshotMutex.unlock();
+}
+
+size_t DataSet::pinSnapshot(size_t slot)
+{
+	SnapshotLock lock(*this, slot);
+
+	_pins[slot % maxSnapshotPins] = _dataVersion;
+
+	return _dataVersion++;
+}
+
+void DataSet::unpinSnapshot(size_t slot)
+{
+	SnapshotLock lock(*this, slot);
+
+	_pins[slot % maxSnapshotPins] = 0;
+}
+
+void DataSet::releaseSnapshotSlot(size_t slot)
+{
+	if (_snapshotLockHolder == slot + 1)
+	{
+		// The engine is gone, so nobody is ever going to unlock it otherwise
+		Log::log() << "DataSet::releaseSnapshotSlot engine " << slot << " died while holding the snapshot lock, freeing it." << std::endl;
+
+		_snapshotLockHolder = 0;
+		new (&_snapshotMutex) boost::interprocess::interprocess_mutex();
+	}
+
+	SnapshotLock lock(*this);
+
+	if (!lock.owns())
+		return;
+
+	_pins[slot % maxSnapshotPins] = 0;
+	_collectSnapshots(_mem);
+}
+
+bool DataSet::_pinnedBetween(size_t fromVersion, size_t untilVersion) const
+{
+	for (size_t pin : _pins)
+		if (pin != 0 && pin >= fromVersion && pin < untilVersion)
+			return true;
+
+	return false;
+}
+
+void DataSet::preserveForSnapshots(Column & column, SegmentManager * mem, size_t slot)
+{
+	if (mem == nullptr)
+		mem = _mem;
+
+	SnapshotLock lock(*this, slot);
+
+	if (!lock.owns())
+		return; // The analysis that pinned it will just see the change, as when it doesn't fit below
+
+	if (column._version == _dataVersion)
+		return; // Already changed in this version, so either preserved or nobody needed it
+
+	_collectSnapshots(mem);
+
+	if (_pinnedBetween(column._version, _dataVersion))
+	{
+		Column * copy = NULL;
+
+		try
+		{
+			copy = mem->construct<Column>(boost::interprocess::anonymous_instance)(mem);
+			copy->_copyContentsFrom(column);
+
+			_snapshots.push_back({ copy, nullptr, 0, column._version, _dataVersion });
+		}
+		catch (boost::interprocess::bad_alloc &)
+		{
+			// Not worth failing the edit over, the analysis that pinned it will just see the change
+			Log::log() << "DataSet::preserveForSnapshots ran out of shared memory copying column " << column.name() << std::endl;
+
+			if (copy != NULL)
+			{
+				copy->_destroyBlocks(mem);
+				mem->destroy_ptr(copy);
+			}
+		}
+	}
+
+	column._version = _dataVersion;
+}
+
+void DataSet::_preserveFilterForSnapshots()
+{
+	SnapshotLock lock(*this);
+
+	if (!lock.owns() || _filterVersion == _dataVersion)
+		return;
+
+	_collectSnapshots(_mem);
+
+	if (_pinnedBetween(_filterVersion, _dataVersion))
+		try
+		{
+			BoolVector * copy = _mem->construct<BoolVector>(boost::interprocess::anonymous_instance)(_filterVector);
+			_snapshots.push_back({ nullptr, copy, _filteredRowCount, _filterVersion, _dataVersion });
+		}
+		catch (boost::interprocess::bad_alloc &) { Log::log() << "DataSet::preserveForSnapshots ran out of shared memory copying the filter" << std::endl; }
+
+	_filterVersion = _dataVersion;
+}
+
+void DataSet::_collectSnapshots(SegmentManager * mem)
+{
+	// Only called with _snapshotMutex locked
+	for (size_t i = 0; i < _snapshots.size();)
+		if (_pinnedBetween(_snapshots[i].fromVersion, _snapshots[i].untilVersion))
+			i++;
+		else
+		{
+			DataSnapshot & snapshot = _snapshots[i];
+
+			if (snapshot.column)
+			{
+				snapshot.column->_destroyBlocks(mem);
+				mem->destroy_ptr(snapshot.column.get());
+			}
+
+			if (snapshot.filter)
+				mem->destroy_ptr(snapshot.filter.get());
+
+			_snapshots.erase(_snapshots.begin() + i);
+		}
+}
+
+void DataSet::clearSnapshots()
+{
+	SnapshotLock lock(*this);
+
+	if (!lock.owns())
+		return;
+
+	for (size_t & pin : _pins)
+		pin = 0;
+
+	_collectSnapshots(_mem);
+}
+
+Column & DataSet::snapshotColumn(const std::string & name, size_t version)
+{
+	int		liveIndex	= getColumnIndex(name);
+	Column	*live		= liveIndex == -1 ? nullptr : &_columns.at(liveIndex);
+
+	if (live && (version == 0 || live->_version <= version))
+		return *live;
+
+	// Either changed or removed since version
+	for (DataSnapshot & snapshot : _snapshots)
+		if (snapshot.column && snapshot.fromVersion <= version && version < snapshot.untilVersion && snapshot.column->name() == name)
+			return *snapshot.column;
+
+	if (live)
+		return *live; // Nobody preserved it, so it must have been changed without going through preserveForSnapshots
+
+	throw columnNotFound(name);
+}
+
+const BoolVector & DataSet::snapshotFilter(size_t version, int & filteredRowCount)
+{
+	if (version != 0 && _filterVersion > version)
+		for (DataSnapshot & snapshot : _snapshots)
+			if (snapshot.filter && snapshot.fromVersion <= version && version < snapshot.untilVersion)
+			{
+				filteredRowCount = snapshot.filteredRowCount;
+				return *snapshot.filter;
+			}
+
+	filteredRowCount = _filteredRowCount;
+	return _filterVector;
+}
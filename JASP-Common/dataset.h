@@ -20,19 +20,55 @@
 
 #include <map>
 
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
 #include "columns.h"
 
-typedef boost::interprocess::allocator<bool, boost::interprocess::managed_shared_memory::segment_manager> BoolAllocator;
+typedef boost::interprocess::allocator<bool, SegmentManager> BoolAllocator;
 typedef boost::container::vector<bool, BoolAllocator> BoolVector;
 
+///A copy of a column, or of the filter when column is null, as it was for the data versions [fromVersion, untilVersion).
+struct DataSnapshot
+{
+	boost::interprocess::offset_ptr<Column>		column;
+	boost::interprocess::offset_ptr<BoolVector>	filter;
+	int											filteredRowCount;
+	size_t										fromVersion,
+												untilVersion;
+};
+
+typedef boost::interprocess::allocator<DataSnapshot, SegmentManager> DataSnapshotAllocator;
+typedef boost::container::vector<DataSnapshot, DataSnapshotAllocator> DataSnapshots;
+
 class DataSet
 {
-	typedef std::map<std::string, std::map<int, std::string>> emptyValsType;
+	typedef std::map<std::string, ColumnEmptyValues> emptyValsType;
 
 public:
 
-	DataSet(boost::interprocess::managed_shared_memory *mem) : _columns(mem), _filterVector(mem->get_segment_manager()), _mem(mem) { }
-	~DataSet() {}
+	static const size_t maxSnapshotPins		= 64,
+						desktopSlot			= size_t(-1),
+						snapshotLockWaitMs	= 500;
+
+	///Holds the lock on the snapshots, which lives in the shared segment and thus outlives whoever holds it.
+	///An engine notes down its slot while it holds it, so the desktop can free it in releaseSnapshotSlot when that engine dies in the meantime.
+	///The desktop only waits snapshotLockWaitMs for it, so a stuck engine can't freeze the interface, and then owns() is false.
+	class SnapshotLock
+	{
+	public:
+		SnapshotLock(DataSet & dataSet, size_t slot = desktopSlot);
+		~SnapshotLock();
+
+		bool owns() const { return _owns; }
+
+	private:
+		DataSet	&	_dataSet;
+		bool		_owns;
+	};
+
+	DataSet(SegmentManager *mem) : _columns(mem), _filterVector(mem), _snapshots(mem), _mem(mem) { }
+	~DataSet() { clearSnapshots(); }
 
 	size_t minRowCount()	const { return _columns.minRowCount(); }
 	size_t maxRowCount()	const { return _columns.maxRowCount(); }
@@ -48,10 +84,12 @@ public:
 	void setColumnCount(size_t columnCount);
 
 
-	void setSharedMemory(boost::interprocess::managed_shared_memory *mem);
+	void setSharedMemory(SegmentManager *mem);
 
 	std::string toString();
-	std::vector<std::string> resetEmptyValues(emptyValsType emptyValuesMap);
+	std::vector<std::string> resetEmptyValues(emptyValsType & emptyValuesMap); ///< Updates emptyValuesMap in place
+
+	static size_t estimateSharedMemorySize(size_t columnCount, size_t rowCount, size_t labelCount); ///< Roughly how many bytes of shared memory a data set of this size will take, so that it can be reserved before filling it
 
 	bool				setFilterVector(std::vector<bool> filterResult);
 	const BoolVector&	filterVector()		const	{ return _filterVector; }
@@ -61,13 +99,37 @@ public:
 	bool synchingData()						const	{ return _synchingData; }
 	void setSynchingData(bool newVal);
 
+	// An engine pins the current version of the data for as long as an analysis runs, and then reads through snapshotColumn and snapshotFilter.
+	// Whoever changes the data calls preserveForSnapshots first, which copies what is about to change when a pinned version can still see it.
+	// Engines pass their own mapping of the segment and their slot, the desktop leaves both out.
+	size_t				dataVersion()		const	{ return _dataVersion; }
+	size_t				pinSnapshot(size_t slot);															///< Returns the pinned version, changes made from now on go into the next one.
+	void				unpinSnapshot(size_t slot);
+	void				releaseSnapshotSlot(size_t slot);													///< For the desktop, once the engine in slot is gone: unpins it and frees the lock when it died holding it.
+	void				preserveForSnapshots(Column & column, SegmentManager * mem = nullptr, size_t slot = desktopSlot);
+	void				clearSnapshots();
+
+	Column			&	snapshotColumn(const std::string & name, size_t version);							///< version 0 is the live data. Hold a SnapshotLock while reading through it.
+	const BoolVector &	snapshotFilter(size_t version, int & filteredRowCount);
+
 private:
+	void				_preserveFilterForSnapshots();
+	bool				_pinnedBetween(size_t fromVersion, size_t untilVersion)	const;
+	void				_collectSnapshots(SegmentManager * mem);
+
 	Columns			_columns;
 	int				_filteredRowCount = 0;
 	BoolVector		_filterVector;
 	bool			_synchingData;
 
-	boost::interprocess::managed_shared_memory *_mem;
+	boost::interprocess::interprocess_mutex	_snapshotMutex;
+	DataSnapshots							_snapshots;
+	size_t									_snapshotLockHolder	= 0,	///< Slot + 1 of the engine holding _snapshotMutex, 0 for nobody or the desktop
+											_dataVersion	= 1,
+											_filterVersion	= 0,
+											_pins[maxSnapshotPins] = {};	///< 0 when the slot isn't pinned
+
+	SegmentManager *_mem;
 };
 
 #endif // DATASET_H
@@ -21,6 +21,7 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include "boost/nowide/convert.hpp"
 #include "log.h"
+#include "tracer.h"
 
 using namespace std;
 using namespace boost;
@@ -211,6 +212,7 @@ void IPCChannel::send(string &data, bool alreadyLockedMutex)
 	try
 	{
 		_dataOut->assign(data.begin(), data.end());
+		JASPTRACE_COUNT(ipcBytesSent, data.size());
 	}
 	catch (boost::interprocess::bad_alloc &e)	{ goto retryAfterDoublingMemory; }
 	catch (std::length_error &e)				{ goto retryAfterDoublingMemory; }
@@ -253,6 +255,7 @@ bool IPCChannel::receive(string &data, int timeout)
 		{
 			rebindMemoryInIfSizeChanged();
 			data.assign(_dataIn->c_str(), _dataIn->size());
+			JASPTRACE_COUNT(ipcBytesReceived, data.size());
 		}
 		catch(std::exception & e)
 		{
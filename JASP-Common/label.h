@@ -39,6 +39,7 @@ public:
 	Label();
 
 	std::string text() const;
+	int textLength() const { return _stringLength; }
 	bool hasIntValue() const;
 	int value() const;
     void setLabel(const std::string &label);
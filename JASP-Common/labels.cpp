@@ -17,8 +17,12 @@
 
 #include "labels.h"
 #include "iostream"
+#include "stringdictionary.h"
+#include <mutex>
+#include <atomic>
 
 #include "log.h"
+#include "processinfo.h"
 
 using namespace std;
 
@@ -27,11 +31,12 @@ int Labels::_counter = 0;
 
 typedef unsigned int uint;
 
-Labels::Labels(boost::interprocess::managed_shared_memory *mem)
-	: _labels(mem->get_segment_manager())
+Labels::Labels(SegmentManager *mem)
+	: _labels(mem)
 {
 	 _id = ++Labels::_counter;
 	_mem = mem;
+	_changed();
 }
 
 Labels::~Labels()
@@ -41,6 +46,15 @@ Labels::~Labels()
 void Labels::clear()
 {
 	_labels.clear();
+	_maxLabelLength = 0;
+	_changed();
+}
+
+void Labels::_changed()
+{
+	// The desktop and the engines both change labels, so the pid goes in the top bits to keep revisions from different processes apart
+	static std::atomic<uint64_t> counter(0);
+	_revision = (uint64_t(ProcessInfo::currentPID()) << 40) | ++counter;
 }
 
 int Labels::add(int display)
@@ -48,6 +62,11 @@ int Labels::add(int display)
 	Label label(display);
 	_labels.push_back(label);
 
+	if (_maxLabelLength != -1)
+		_maxLabelLength = std::max(_maxLabelLength, label.textLength());
+
+	_changed();
+
 	return display;
 }
 
@@ -61,6 +80,11 @@ int Labels::add(int key, const std::string &display, bool filterAllows)
 	Label label(display, key, filterAllows);
 	_labels.push_back(label);
 
+	if (_maxLabelLength != -1)
+		_maxLabelLength = std::max(_maxLabelLength, label.textLength());
+
+	_changed();
+
 	return key;
 }
 
@@ -74,6 +98,9 @@ void Labels::removeValues(std::set<int> valuesToRemove)
 				return std::find(valuesToRemove.begin(), valuesToRemove.end(), label.value()) != valuesToRemove.end();
 			}),
 				_labels.end());
+
+	_maxLabelLength = -1;
+	_changed();
 }
 
 std::map<string, int> Labels::_resetLabelValues(int& maxValue)
@@ -96,6 +123,7 @@ std::map<string, int> Labels::_resetLabelValues(int& maxValue)
 	orgStringValues.clear();
 	orgStringValues.insert(newOrgStringValues.begin(), newOrgStringValues.end());
 	maxValue = labelValue - 1;
+	_changed();
 
 	return result;
 }
@@ -155,22 +183,40 @@ bool Labels::syncInts(const std::set<int> &values)
 
 std::map<std::string, int> Labels::syncStrings(const std::vector<std::string> &new_values, const std::map<std::string, std::string> &new_labels, bool *changedSomething)
 {
-	std::vector<std::pair<std::string,std::string> > valuesToAdd;
-	std::map<std::string, std::vector<unsigned int> > mapValuesToAdd;
-	unsigned int valuesToAddIndex = 0;
-
-	for (const std::string& newValue : new_values)
+	// The labels are matched on the (possibly shortened) values, several values can share one of those.
+	// Every distinct short value gets a code and the values with the same code are chained through nextWithSameCode.
+	std::vector<std::string>	shortValues;
+	std::vector<int>			shortCodes,
+								firstWithCode,
+								lastWithCode,
+								nextWithSameCode(new_values.size(), -1);
+	StringDictionary			shortDictionary(new_values.size());
+
+	shortValues.reserve(new_values.size()); // The dictionary points into shortValues, so it may never reallocate
+	shortCodes.reserve(new_values.size());
+
+	for (size_t i = 0; i < new_values.size(); i++)
 	{
-		std::string shortValue	= newValue.length() > Label::MAX_LABEL_LENGTH ? newValue.substr(0, Label::MAX_LABEL_LENGTH) : newValue;
-		valuesToAdd.push_back(make_pair(newValue, shortValue));
-		auto elt = mapValuesToAdd.find(shortValue);
-		if (elt != mapValuesToAdd.end())
-			elt->second.push_back(valuesToAddIndex);
+		const std::string& newValue = new_values[i];
+		shortValues.push_back(newValue.length() > Label::MAX_LABEL_LENGTH ? newValue.substr(0, Label::MAX_LABEL_LENGTH) : newValue);
+
+		int code = shortDictionary.encode(shortValues.back());
+		shortCodes.push_back(code);
+
+		if (size_t(code) == firstWithCode.size())
+		{
+			firstWithCode.push_back(i);
+			lastWithCode.push_back(i);
+		}
 		else
-			mapValuesToAdd[shortValue] = { valuesToAddIndex };
-		valuesToAddIndex++;
+		{
+			nextWithSameCode[lastWithCode[code]]	= i;
+			lastWithCode[code]						= i;
+		}
 	}
-	
+
+	std::vector<bool>			codeHasLabel(shortDictionary.size(), false);
+	size_t						codesWithLabel = 0;
 	std::set<int>				valuesToRemove;
 	std::map<std::string, int>	result;
 	int							maxLabelKey = 0;
@@ -183,18 +229,19 @@ std::map<std::string, int> Labels::syncStrings(const std::vector<std::string> &n
 		if (labelValue > maxLabelKey)
 			maxLabelKey = labelValue;
 
-		auto elt = mapValuesToAdd.find(labelText);
-		if (elt != mapValuesToAdd.end())
+		int code = shortDictionary.find(labelText);
+		if (code != -1 && !codeHasLabel[code])
 		{
-			for (uint i : elt->second)
-				result[valuesToAdd[i].first] = labelValue;
-			mapValuesToAdd.erase(elt);
+			for (int i = firstWithCode[code]; i != -1; i = nextWithSameCode[i])
+				result[new_values[i]] = labelValue;
+			codeHasLabel[code] = true;
+			codesWithLabel++;
 		}
 		else
 			valuesToRemove.insert(labelValue);
 	}
 
-	if(changedSomething != nullptr && (valuesToRemove.size() > 0 || mapValuesToAdd.size() > 0))
+	if(changedSomething != nullptr && (valuesToRemove.size() > 0 || codesWithLabel < shortDictionary.size()))
 		*changedSomething = true;
 
 	if (valuesToRemove.size() > 0)
@@ -203,17 +250,13 @@ std::map<std::string, int> Labels::syncStrings(const std::vector<std::string> &n
 		result = _resetLabelValues(maxLabelKey);
 	}
 	
-	for (auto elt : valuesToAdd)
-	{
-		const std::string& newLabel = elt.first;
-		const std::string& shortLabel = elt.second;
-		if (mapValuesToAdd.find(shortLabel) != mapValuesToAdd.end())
+	for (size_t i = 0; i < new_values.size(); i++)
+		if (!codeHasLabel[shortCodes[i]])
 		{
 			maxLabelKey++;
-			add(maxLabelKey, shortLabel, true);
-			result[newLabel] = maxLabelKey;
+			add(maxLabelKey, shortValues[i], true);
+			result[new_values[i]] = maxLabelKey;
 		}
-	}
 
 	for (Label& label : _labels)
 	{
@@ -245,6 +288,10 @@ std::set<int> Labels::getIntValues()
 
 map<int, string> &Labels::getOrgStringValues() const
 {
+	// Columns can be processed on separate threads (DataSet::resetEmptyValues), they each only touch their own entry but adding one changes the outer map
+	static std::mutex orgStringValuesLock;
+	std::lock_guard<std::mutex> guard(orgStringValuesLock);
+
 	return Labels::_orgStringValues[_id];
 }
 
@@ -302,6 +349,9 @@ void Labels::_setNewStringForLabel(Label &label, const string &display)
 	if (orgStringValues.find(label_value) == orgStringValues.end())
 		orgStringValues[label_value] = label_string;
 	label.setLabel(display);
+
+	_maxLabelLength = -1;
+	_changed();
 }
 
 string Labels::_getValueFromLabel(const Label &label) const
@@ -347,6 +397,8 @@ string Labels::getValueFromRow(int row)
 
 Label& Labels::operator[](size_t index)
 {
+	_maxLabelLength = -1; // The caller might change the label through the reference
+	_changed();
 	return _labels.at(index);
 }
 
@@ -368,6 +420,9 @@ void Labels::set(vector<Label> &labels)
 	{
 		_labels.push_back(label);
 	}
+
+	_maxLabelLength = -1;
+	_changed();
 }
 
 size_t Labels::size() const
@@ -375,18 +430,32 @@ size_t Labels::size() const
 	return _labels.size();
 }
 
+int Labels::maxLabelLength() const
+{
+	if (_maxLabelLength == -1)
+	{
+		_maxLabelLength = 0;
+		for (const Label &label : _labels)
+			_maxLabelLength = std::max(_maxLabelLength, label.textLength());
+	}
+
+	return _maxLabelLength;
+}
+
 Labels &Labels::operator=(const Labels &labels)
 {
 	if (&labels != this)
 	{
 		this->_mem = labels._mem;
 		this->_labels = labels._labels;
+		this->_maxLabelLength = labels._maxLabelLength;
+		this->_revision = labels._revision;
 	}
 
 	return *this;
 }
 
-void Labels::setSharedMemory(boost::interprocess::managed_shared_memory *mem)
+void Labels::setSharedMemory(SegmentManager *mem)
 {
 	_mem = mem;
 }
@@ -22,6 +22,7 @@
 #include <map>
 #include <vector>
 #include <set>
+#include <cstdint>
 
 #include <boost/container/vector.hpp>
 #include <boost/container/map.hpp>
@@ -29,7 +30,10 @@
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/interprocess/segment_manager.hpp>
 
-typedef boost::interprocess::allocator<Label, boost::interprocess::managed_shared_memory::segment_manager> LabelAllocator;
+///The segment_manager of managed_shared_memory and managed_mapped_file is the same type, so the data classes work on either backing (see SharedMemory)
+typedef boost::interprocess::managed_shared_memory::segment_manager SegmentManager;
+
+typedef boost::interprocess::allocator<Label, SegmentManager> LabelAllocator;
 typedef boost::container::vector<Label, LabelAllocator> LabelVector;
 
 #include <boost/iterator/iterator_facade.hpp>
@@ -38,7 +42,7 @@ typedef boost::container::vector<Label, LabelAllocator> LabelVector;
 class Labels
 {
 public:
-	Labels(boost::interprocess::managed_shared_memory *mem);
+	Labels(SegmentManager *mem);
 	virtual ~Labels();
 
 	void clear();
@@ -53,11 +57,13 @@ public:
 
 	void set(std::vector<Label> &labels);
 	size_t size() const;
+	int maxLabelLength() const;
+	uint64_t revision() const { return _revision; } ///< Changes whenever the labels do and is unique over processes, so the engines can key their R levels on it
 
 	Labels& operator=(const Labels& labels);
 	Label& operator[](size_t index);
 
-	void setSharedMemory(boost::interprocess::managed_shared_memory *mem);
+	void setSharedMemory(SegmentManager *mem);
 	typedef LabelVector::const_iterator const_iterator;
 
 	const_iterator begin() const;
@@ -84,10 +90,13 @@ private:
 	std::string _getValueFromLabel(const Label &label) const;
 	std::string _getOrgValueFromLabel(const Label &label) const;
 	std::map<std::string, int> _resetLabelValues(int &maxValue);
+	void _changed();
 
-	boost::interprocess::managed_shared_memory *_mem;
+	SegmentManager *_mem;
 	LabelVector _labels;
 	int _id;
+	mutable int _maxLabelLength = -1; // Longest label text, -1 when it needs to be determined again. Plain int because Labels can live in shared memory.
+	uint64_t _revision;
 	static int _counter;
 	// Original string values: used only when value is a string and when the label has been changed
 	// This map is not in the shared memory (it's only used by the JASP-Desktop): this allows this map to grow
@@ -1,5 +1,6 @@
 #define ENUM_DECLARATION_CPP
 #include "log.h"
+#include "tracer.h"
 #include "boost/nowide/cstdio.hpp"
 #include <chrono>
 #ifdef WIN32
@@ -97,6 +98,9 @@ void Log::redirectStdOut()
 		//_currentFile = freopen(_logFilePath.c_str(), "a", stdout);
 		//if(!_currentFile)
 
+		if(_logFile.is_open()) //For instance when an engine forked from the zygote gets its own logfile
+			_logFile.close();
+
 		_logFile.open(_logFilePath.c_str(), std::ios_base::app | std::ios_base::out);
 
 		if(_logFile.fail())
@@ -118,6 +122,7 @@ Json::Value	Log::createLogCfgMsg()
 	Json::Value json	= Json::objectValue;
 
 	json["where"]		= logTypeToString(_where);
+	json["trace"]		= Tracer::enabled();
 
 	return json;
 }
@@ -125,6 +130,7 @@ Json::Value	Log::createLogCfgMsg()
 void Log::parseLogCfgMsg(const Json::Value & json)
 {
 	setWhere(logTypeFromString(json["where"].asString()));
+	Tracer::setEnabled(json.get("trace", false).asBool());
 }
 
 std::ostream & Log::log()
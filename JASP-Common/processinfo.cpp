@@ -22,8 +22,12 @@
 #include <tlhelp32.h>
 #else
 #include "unistd.h"
+#include <signal.h>
+#include <cerrno>
 #endif
 
+unsigned long ProcessInfo::_watchedParentPID = 0;
+
 unsigned long ProcessInfo::currentPID()
 {
 
@@ -86,6 +90,9 @@ bool ProcessInfo::isParentRunning()
 		return ( ! success) || exitCode == STILL_ACTIVE;
 	}
 #else
+	if(_watchedParentPID != 0)
+		return kill(pid_t(_watchedParentPID), 0) == 0 || errno == EPERM;
+
 	return getppid() != 1;
 #endif
 }
@@ -27,6 +27,11 @@ public:
 
 	static bool isParentRunning();
 
+	///Engines forked from the zygote are not children of the desktop, so they keep an eye on it through its pid instead (only on unixes).
+	static void watchAsParent(unsigned long pid) { _watchedParentPID = pid; }
+
+private:
+	static unsigned long _watchedParentPID;
 };
 
 #endif // PROCESS_H
@@ -19,78 +19,180 @@
 
 #include "processinfo.h"
 #include "tempfiles.h"
+#include "dirs.h"
+#include "utils.h"
 
 #include <sstream>
+#include <algorithm>
+#include <boost/filesystem.hpp>
 
 #include "log.h"
 
 using namespace std;
 using namespace boost;
 
-interprocess::managed_shared_memory *SharedMemory::_memory = NULL;
+interprocess::managed_shared_memory	*SharedMemory::_memory		= NULL;
+interprocess::managed_mapped_file	*SharedMemory::_mappedFile	= NULL;
+SegmentManager						*SharedMemory::_segment		= NULL;
+bool								 SharedMemory::_useMappedFile	= false;
 string SharedMemory::_memoryName;
+size_t	*SharedMemory::_generation			= NULL,
+		 SharedMemory::_mappedGeneration	= 0;
+
+static const char	*	generationName		= "JASP-GENERATION";
+static const size_t		initialMemorySize	= 6 * 1024 * 1024;
+
+string SharedMemory::mappedFileName(unsigned long pid)
+{
+	// Starts with "JASP-" so TempFiles::deleteOrphans cleans it up when a crashed JASP left it behind
+	return Dirs::tempDir() + "/JASP-DATA-" + std::to_string(pid) + "-mapped";
+}
 
 DataSet *SharedMemory::createDataSet()
 {
-	if (_memory == NULL)
+	if (_segment == NULL)
 	{
 		stringstream ss;
 		ss << "JASP-DATA-";
 		ss << ProcessInfo::currentPID();
 		_memoryName = ss.str();
 
-		TempFiles::addShmemFileName(_memoryName);
+		if (_useMappedFile)
+		{
+			string fileName = _memoryName + "-mapped";
+			TempFiles::addShmemFileName(fileName); // so the heartbeat keeps it from being seen as an orphan
+
+			_memoryName = mappedFileName(ProcessInfo::currentPID());
+
+			interprocess::file_mapping::remove(_memoryName.c_str());
+			_mappedFile = new interprocess::managed_mapped_file(interprocess::create_only, _memoryName.c_str(), initialMemorySize);
+			_segment	= _mappedFile->get_segment_manager();
 
-		interprocess::shared_memory_object::remove(_memoryName.c_str());
-		_memory = new interprocess::managed_shared_memory(interprocess::create_only, _memoryName.c_str(), 6 * 1024 * 1024);
+			Log::log() << "SharedMemory::createDataSet keeps the data in the mapped file " << _memoryName << std::endl;
+		}
+		else
+		{
+			TempFiles::addShmemFileName(_memoryName);
+
+			interprocess::shared_memory_object::remove(_memoryName.c_str());
+			_memory		= new interprocess::managed_shared_memory(interprocess::create_only, _memoryName.c_str(), initialMemorySize);
+			_segment	= _memory->get_segment_manager();
+		}
+
+		_generation			= _segment->construct<size_t>(generationName)(0);
+		_mappedGeneration	= 0;
 	}
 
-	DataSet * data = _memory->construct<DataSet>(interprocess::unique_instance)(_memory);
+	DataSet * data = _segment->construct<DataSet>(interprocess::unique_instance)(_segment);
 	return data;
 }
 
 DataSet *SharedMemory::retrieveDataSet(unsigned long parentPID)
 {
-	if (_memory == NULL)
+	if (_segment != NULL && remapped())
+	{
+		Log::log() << "SharedMemory::retrieveDataSet the data was moved to a larger segment, mapping it again." << std::endl;
+		unloadDataSet();
+	}
+
+	if (_segment == NULL)
 	{
 		if(parentPID == 0)
 			parentPID = ProcessInfo::parentPID();
 
-		_memoryName = "JASP-DATA-" + std::to_string(parentPID);
-		_memory		= new interprocess::managed_shared_memory(interprocess::open_only, _memoryName.c_str());
+		// The desktop made either the mapped file or the shared memory, not both
+		system::error_code	error;
+		string				fileName = mappedFileName(parentPID);
+
+		_useMappedFile	= filesystem::exists(Utils::osPath(fileName), error);
+		_memoryName		= _useMappedFile ? fileName : "JASP-DATA-" + std::to_string(parentPID);
+
+		openMemory();
 	}
 
-	DataSet * data = _memory->find<DataSet>(interprocess::unique_instance).first;
+	DataSet * data = _segment->find<DataSet>(interprocess::unique_instance).first;
 
 	return data;
 }
 
-DataSet *SharedMemory::enlargeDataSet(DataSet *)
+void SharedMemory::openMemory()
 {
-	size_t extraSize = _memory->get_size();
+	if (_useMappedFile)
+	{
+		_mappedFile	= new interprocess::managed_mapped_file(interprocess::open_only, _memoryName.c_str());
+		_segment	= _mappedFile->get_segment_manager();
+	}
+	else
+	{
+		_memory		= new interprocess::managed_shared_memory(interprocess::open_only, _memoryName.c_str());
+		_segment	= _memory->get_segment_manager();
+	}
 
-	Log::log() << "SharedMemory::enlargeDataSet to " << extraSize << std::endl;
+	_generation			= _segment->find<size_t>(generationName).first;
+	_mappedGeneration	= generation();
+}
 
-	delete _memory;
+DataSet *SharedMemory::enlargeDataSet(DataSet *, size_t minimumFree)
+{
+	// At least doubling keeps the number of remaps logarithmic in the final size, minimumFree lets a caller that knows what is coming skip the intermediate steps
+	size_t	currentSize	= _segment->get_size(),
+			freeMemory	= _segment->get_free_memory(),
+			extraSize	= std::max(currentSize, minimumFree > freeMemory ? minimumFree - freeMemory : 0);
+
+	Log::log() << "SharedMemory::enlargeDataSet from " << currentSize << " by " << extraSize << std::endl;
+
+	closeMemory();
 
-	interprocess::managed_shared_memory::grow(_memoryName.c_str(), extraSize);
-	_memory = new interprocess::managed_shared_memory(interprocess::open_only, _memoryName.c_str());
+	if (_useMappedFile)	interprocess::managed_mapped_file::grow(_memoryName.c_str(), extraSize);
+	else				interprocess::managed_shared_memory::grow(_memoryName.c_str(), extraSize);
+
+	openMemory();
+
+	// Only the desktop grows the segment and the engines are paused while it does, so nobody is reading this at the same time
+	if (_generation != NULL)
+		_mappedGeneration = ++(*_generation);
 
 	DataSet *dataSet = retrieveDataSet();
-	dataSet->setSharedMemory(_memory);
+	dataSet->setSharedMemory(_segment);
 
 	return dataSet;
 }
 
+DataSet *SharedMemory::reserveDataSet(DataSet *dataSet, size_t expectedSize)
+{
+	if (_segment == NULL || _segment->get_free_memory() >= expectedSize)
+		return dataSet;
+
+	return enlargeDataSet(dataSet, expectedSize);
+}
+
+size_t SharedMemory::generation()
+{
+	return _generation == NULL ? 0 : *_generation;
+}
+
+bool SharedMemory::remapped()
+{
+	return _segment != NULL && generation() != _mappedGeneration;
+}
+
 void SharedMemory::deleteDataSet(DataSet *dataSet)
 {
-	_memory->destroy_ptr(dataSet);
+	_segment->destroy_ptr(dataSet);
 }
 
-void SharedMemory::unloadDataSet()
+void SharedMemory::closeMemory()
 {
-	if(_memory != NULL)
-		delete _memory;
+	delete _memory;
+	delete _mappedFile;
+
+	_memory		= NULL;
+	_mappedFile	= NULL;
+	_segment	= NULL;
+	_generation	= NULL;
+}
 
-	_memory = NULL;
+void SharedMemory::unloadDataSet()
+{
+	closeMemory();
 }
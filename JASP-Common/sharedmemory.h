@@ -19,6 +19,7 @@
 #define SHAREDMEMORY_H
 
 #include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/managed_mapped_file.hpp>
 #include "dataset.h"
 
 /*
@@ -32,6 +33,11 @@
  * in shared memory as well.
  * Good examples of creating and populating a DataSet can be found
  * in the importers
+ *
+ * With setUseMappedFile(true) the segment is a memory-mapped file in the
+ * temp directory instead, so data sets larger than the available memory
+ * (or /dev/shm) get paged from disk. The engines find out which one
+ * it is by looking for that file.
  */
 
 class SharedMemory
@@ -39,14 +45,30 @@ class SharedMemory
 public:
 
 	static DataSet	*createDataSet();
-	static DataSet	*retrieveDataSet(unsigned long parentPID = 0);
-	static DataSet	*enlargeDataSet(DataSet *dataSet);
+	static DataSet	*retrieveDataSet(unsigned long parentPID = 0);					///< Maps the segment again first when it was grown since it was mapped here.
+	static DataSet	*enlargeDataSet(DataSet *dataSet, size_t minimumFree = 0);		///< Grows the segment by at least its current size, and further when needed to get minimumFree bytes free.
+	static DataSet	*reserveDataSet(DataSet *dataSet, size_t expectedSize);			///< Grows the segment once, up front, when expectedSize won't fit in what is free.
 	static void		deleteDataSet(DataSet *dataSet);
 	static void		unloadDataSet();
+
+	static void		setUseMappedFile(bool useMappedFile) { _useMappedFile = useMappedFile; }	///< Only has an effect before the first createDataSet()
+
+	static size_t	generation();		///< Goes up every time the segment is grown and thus remapped.
+	static bool		remapped();			///< Whether the segment was grown since this process mapped it.
+	static SegmentManager	*segment()	{ return _segment; }		///< As mapped in this process, NULL before the data set was created or retrieved.
+
 private:
+	static void		openMemory();
+	static void		closeMemory();
+	static std::string	mappedFileName(unsigned long pid);
 
 	static std::string _memoryName;
-	static boost::interprocess::managed_shared_memory *_memory;
+	static boost::interprocess::managed_shared_memory	*	_memory;
+	static boost::interprocess::managed_mapped_file		*	_mappedFile;
+	static SegmentManager								*	_segment;			///< Of whichever of the two above is in use
+	static bool												_useMappedFile;
+	static size_t		*	_generation,		///< Lives in the segment itself, so every process sees the same one
+							_mappedGeneration;	///< What *_generation was when this process mapped the segment
 
 };
 
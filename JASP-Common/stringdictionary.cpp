@@ -0,0 +1,65 @@
+#include "stringdictionary.h"
+#include <functional>
+
+StringDictionary::StringDictionary(size_t expectedDistinct)
+{
+	size_t capacity = 16;
+
+	while(capacity < expectedDistinct * 2) //Keep the load below a half
+		capacity *= 2;
+
+	_slots.assign(capacity, -1);
+	_mask = capacity - 1;
+}
+
+size_t StringDictionary::slotFor(const std::string & value, size_t hash) const
+{
+	size_t slot = hash & _mask;
+
+	//Linear probing, ends at either an empty slot or the one that holds value
+	while(_slots[slot] != -1 && (_hashes[_slots[slot]] != hash || *_distinct[_slots[slot]] != value))
+		slot = (slot + 1) & _mask;
+
+	return slot;
+}
+
+int StringDictionary::encode(const std::string & value)
+{
+	size_t	hash = std::hash<std::string>()(value),
+			slot = slotFor(value, hash);
+
+	if(_slots[slot] != -1)
+		return _slots[slot];
+
+	int code = int(_distinct.size());
+
+	_slots[slot] = code;
+	_hashes.push_back(hash);
+	_distinct.push_back(&value);
+
+	if(_distinct.size() * 2 > _slots.size())
+		grow();
+
+	return code;
+}
+
+int StringDictionary::find(const std::string & value) const
+{
+	return _slots[slotFor(value, std::hash<std::string>()(value))];
+}
+
+void StringDictionary::grow()
+{
+	_slots.assign(_slots.size() * 2, -1);
+	_mask = _slots.size() - 1;
+
+	for(size_t code=0; code<_distinct.size(); code++)
+	{
+		size_t slot = _hashes[code] & _mask;
+
+		while(_slots[slot] != -1)
+			slot = (slot + 1) & _mask;
+
+		_slots[slot] = int(code);
+	}
+}
@@ -0,0 +1,30 @@
+#ifndef STRINGDICTIONARY_H
+#define STRINGDICTIONARY_H
+
+#include <string>
+#include <vector>
+
+///Dictionary-encodes strings: every distinct string gets a code, in order of first appearance, through an open-addressing hashtable.
+///Only pointers to the strings are kept, so they must outlive the dictionary and may not move.
+class StringDictionary
+{
+public:
+	StringDictionary(size_t expectedDistinct = 16);
+
+	int					encode(const std::string & value);			///< Returns the code of value, adding it if it wasn't there yet.
+	int					find(const std::string & value)	const;		///< Returns the code of value or -1.
+
+	size_t				size()							const	{ return _distinct.size();	}
+	const std::string &	operator[](size_t code)			const	{ return *_distinct[code];	}
+
+private:
+	size_t				slotFor(const std::string & value, size_t hash) const;
+	void				grow();
+
+	std::vector<int>					_slots;		///< -1 when empty, otherwise a code
+	std::vector<size_t>					_hashes;	///< [code], so growing doesn't need to hash everything again
+	std::vector<const std::string *>	_distinct;	///< [code]
+	size_t								_mask;
+};
+
+#endif // STRINGDICTIONARY_H
@@ -18,6 +18,8 @@
 #include "tempfiles.h"
 
 #include <sstream>
+#include <ctime>
+#include <algorithm>
 #include <boost/filesystem.hpp>
 
 #include "boost/nowide/fstream.hpp"
@@ -27,6 +29,7 @@
 
 #include "dirs.h"
 #include "log.h"
+#include "processinfo.h"
 using namespace std;
 using namespace boost;
 
@@ -37,6 +40,7 @@ std::string				TempFiles::_clipboard		= "";
 int						TempFiles::_nextFileId		= 0;
 int						TempFiles::_nextTmpFolderId	= 0;
 TempFiles::stringvec	TempFiles::_shmemNames		= TempFiles::stringvec();
+const size_t			TempFiles::_renderCacheMaxBytes	= 256 * 1024 * 1024;
 
 void TempFiles::init(long sessionId)
 {
@@ -79,6 +83,156 @@ void TempFiles::deleteAll(int id)
 }
 
 
+static void copyDirectoryContents(const filesystem::path & from, const filesystem::path & to)
+{
+	system::error_code error;
+
+	filesystem::remove_all(to, error);
+	filesystem::create_directories(to, error);
+
+	for (filesystem::recursive_directory_iterator itr(from, error); !error && itr != filesystem::recursive_directory_iterator(); itr.increment(error))
+	{
+		filesystem::path target = to / filesystem::relative(itr->path(), from, error);
+
+		if (filesystem::is_directory(itr->status()))	filesystem::create_directories(target, error);
+		else											filesystem::copy_file(itr->path(), target, filesystem::copy_option::overwrite_if_exists, error);
+	}
+}
+
+void TempFiles::copyToResultsCache(int id, const string &entry, const stringvec &files)
+{
+	system::error_code	error;
+	string				resources	= "resources/" + std::to_string(id) + "/";
+	filesystem::path	from		= Utils::osPath(_sessionDirName + "/" + resources),
+						to			= Utils::osPath(_sessionDirName + "/resultsCache/" + std::to_string(id) + "/" + entry);
+
+	filesystem::remove_all(to, error);
+	filesystem::create_directories(to, error);
+
+	// Whatever else lies around in there belongs to earlier runs, the state files are needed for the next one though
+	stringvec toCopy = { "state", "jaspResults.json" };
+
+	for (const string & file : files)
+		if (file.compare(0, resources.size(), resources) == 0)
+			toCopy.push_back(file.substr(resources.size()));
+
+	for (const string & file : toCopy)
+	{
+		filesystem::path source = from / file;
+
+		if (!filesystem::exists(source, error))
+			continue;
+
+		filesystem::create_directories((to / file).parent_path(), error);
+		filesystem::copy_file(source, to / file, filesystem::copy_option::overwrite_if_exists, error);
+	}
+}
+
+bool TempFiles::restoreFromResultsCache(int id, const string &entry)
+{
+	system::error_code	error;
+	filesystem::path	cached = Utils::osPath(_sessionDirName + "/resultsCache/" + std::to_string(id) + "/" + entry);
+
+	if (!filesystem::exists(cached, error) || error)
+		return false;
+
+	copyDirectoryContents(cached, Utils::osPath(_sessionDirName + "/resources/" + std::to_string(id)));
+	return true;
+}
+
+void TempFiles::deleteResultsCache(int id, const string &entry)
+{
+	system::error_code error;
+	filesystem::remove_all(Utils::osPath(_sessionDirName + "/resultsCache/" + std::to_string(id) + (entry == "" ? "" : "/" + entry)), error);
+}
+
+bool TempFiles::restoreFromRenderCache(const string &key, const string &relativePath)
+{
+	system::error_code	error;
+	filesystem::path	cached	= Utils::osPath(_sessionDirName + "/renderCache/" + key),
+						target	= Utils::osPath(_sessionDirName + "/" + relativePath);
+
+	if (!filesystem::exists(cached, error) || error)
+		return false;
+
+	filesystem::create_directories(target.parent_path(), error);
+	filesystem::copy_file(cached, target, filesystem::copy_option::overwrite_if_exists, error);
+
+	if (error)
+		return false;
+
+	filesystem::last_write_time(cached, std::time(nullptr), error); //So pruneRenderCache removes the least recently used ones
+	return true;
+}
+
+void TempFiles::copyToRenderCache(const string &key, const string &relativePath, bool newPlot)
+{
+	system::error_code	error;
+	filesystem::path	cacheDir	= Utils::osPath(_sessionDirName + "/renderCache"),
+						cached		= cacheDir / Utils::osPath(key),
+						partial		= cacheDir / Utils::osPath(key + "." + std::to_string(ProcessInfo::currentPID()) + ".partial");
+
+	//A new plot may reuse the png name of one that was deleted, whose renderings would otherwise be restored for it
+	if (newPlot)
+		filesystem::remove_all(cached.parent_path(), error);
+
+	filesystem::create_directories(cached.parent_path(), error);
+
+	//Several engines share the cache, so the file is only renamed into place once it is complete
+	filesystem::copy_file(Utils::osPath(_sessionDirName + "/" + relativePath), partial, filesystem::copy_option::overwrite_if_exists, error);
+
+	if (!error)	filesystem::rename(partial, cached, error);
+	if (error)	filesystem::remove(partial, error);
+}
+
+void TempFiles::pruneRenderCache()
+{
+	system::error_code	error;
+	filesystem::path	cacheDir = Utils::osPath(_sessionDirName + "/renderCache");
+
+	if (!filesystem::exists(cacheDir, error) || error)
+		return;
+
+	std::vector<std::pair<std::time_t, filesystem::path>>	files;
+	size_t													totalBytes = 0;
+
+	for (filesystem::recursive_directory_iterator itr(cacheDir, error); !error && itr != filesystem::recursive_directory_iterator(); itr.increment(error))
+	{
+		system::error_code	fileError;
+
+		if (!filesystem::is_regular_file(itr->path(), fileError))
+			continue;
+
+		size_t				bytes		= filesystem::file_size(itr->path(), fileError);
+		std::time_t			written		= filesystem::last_write_time(itr->path(), fileError);
+
+		if (fileError)
+			continue;
+
+		totalBytes += bytes;
+		files.push_back(std::make_pair(written, itr->path()));
+	}
+
+	if (totalBytes <= _renderCacheMaxBytes)
+		return;
+
+	std::sort(files.begin(), files.end());
+
+	for (auto & file : files)
+	{
+		if (totalBytes <= _renderCacheMaxBytes / 2)
+			break;
+
+		size_t bytes = filesystem::file_size(file.second, error);
+
+		if (!error && filesystem::remove(file.second, error))
+		{
+			totalBytes -= bytes;
+			filesystem::remove(file.second.parent_path(), error); //Only succeeds once the last rendering of that plot is gone
+		}
+	}
+}
+
 void TempFiles::deleteOrphans()
 {
 	Log::log() << "TempFiles::deleteOrphans started" << std::endl;
@@ -183,6 +337,8 @@ void TempFiles::heartbeat()
 	Utils::touch(_statusFileName);
 	for (string & shmemName : _shmemNames)
 		Utils::touch(shmemName);
+
+	pruneRenderCache();
 }
 
 void TempFiles::purgeClipboard()
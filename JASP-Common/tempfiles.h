@@ -62,6 +62,18 @@ public:
 
 	static void			deleteList(const stringvec &files);
 	static void			deleteAll(int id = -1);
+
+	///Copies (or restores) the files of analysis id its results refer to, like its plots, plus its state to (or from) the results cache under the name entry, so that its results can be shown again without rerunning it.
+	///files are relative to the session directory, as they appear in the results.
+	static void			copyToResultsCache(int id, const std::string &entry, const stringvec &files);
+	static bool			restoreFromResultsCache(int id, const std::string &entry);
+	static void			deleteResultsCache(int id, const std::string &entry = "");
+
+	///Renderings of plots are kept under key, "<hash of the png name>/<hash of the render parameters>.png", so drawing a plot again at a size or ppi it had before is only a copy.
+	///newPlot drops the renderings kept for an earlier plot under the same png name.
+	static bool			restoreFromRenderCache(const std::string &key, const std::string &relativePath);
+	static void			copyToRenderCache(const std::string &key, const std::string &relativePath, bool newPlot);
+	static void			pruneRenderCache();
 	static void			deleteOrphans();
 
 	static void			addShmemFileName(std::string &name);
@@ -75,6 +87,7 @@ private:
 	static int			_nextFileId,
 						_nextTmpFolderId;
 	static stringvec	_shmemNames;
+	static const size_t	_renderCacheMaxBytes;
 };
 
 
@@ -19,12 +19,14 @@ void _printAllTimers();
 #define JASPTIMER_PRINTALL() _printAllTimers()
 
 #else
-//No timers please!
-#define JASPTIMER_START(  TIMERNAME ) /* TIMERNAME */
-#define JASPTIMER_RESUME( TIMERNAME ) /* TIMERNAME */
-#define JASPTIMER_STOP(   TIMERNAME ) /* TIMERNAME */
+//No cpu-timers please, but do record them as spans when tracing was switched on at runtime (see tracer.h)
+#include "tracer.h"
+
+#define JASPTIMER_START(  TIMERNAME ) Tracer::begin( #TIMERNAME )
+#define JASPTIMER_RESUME( TIMERNAME ) Tracer::begin( #TIMERNAME )
+#define JASPTIMER_STOP(   TIMERNAME ) Tracer::end( #TIMERNAME )
 #define JASPTIMER_PRINT(  TIMERNAME ) /* TIMERNAME */
-#define JASPTIMER_FINISH( TIMERNAME ) /* TIMERNAME */
+#define JASPTIMER_FINISH( TIMERNAME ) Tracer::end( #TIMERNAME )
 #define JASPTIMER_PRINTALL() /* bla bla bla */
 #endif
 
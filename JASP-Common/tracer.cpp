@@ -0,0 +1,208 @@
+#include "tracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "boost/nowide/fstream.hpp"
+#include "processinfo.h"
+#include "log.h"
+
+std::atomic<bool>	Tracer::_enabled(false);
+std::string			Tracer::_outputFile = "";
+
+namespace
+{
+	struct TraceEvent
+	{
+		const char *	name;
+		char			phase;		//As in the Chrome-trace format: 'B'egin, 'E'nd, 'X' complete or 'C'ounter
+		int64_t			timestamp,	//microseconds
+						value;		//duration for 'X' and amount for 'C'
+		size_t			threadId;
+	};
+
+	///Only its own thread appends to it, without locking: busy tells whoever collects the events to wait for the append to finish.
+	struct TraceBuffer
+	{
+		static const size_t capacity = 1 << 16;
+
+		TraceBuffer(size_t threadId) : busy(false), threadId(threadId), events(capacity) {}
+
+		std::atomic<bool>		busy;
+		size_t					threadId,
+								recorded = 0; //All events ever recorded, the most recent capacity of them are kept
+		std::vector<TraceEvent>	events;
+	};
+
+	std::mutex									toggleLock,
+												buffersLock;
+	std::vector<std::shared_ptr<TraceBuffer>>	buffers;
+
+	TraceBuffer & threadBuffer()
+	{
+		thread_local std::shared_ptr<TraceBuffer> buffer;
+
+		if(!buffer)
+		{
+			std::lock_guard<std::mutex> guard(buffersLock);
+			buffer = std::make_shared<TraceBuffer>(buffers.size());
+			buffers.push_back(buffer);
+		}
+
+		return *buffer;
+	}
+
+	const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+	void writeEscaped(std::ostream & out, const char * str)
+	{
+		for(; *str != '\0'; str++)
+		{
+			if(*str == '"' || *str == '\\')
+				out << '\\';
+			out << *str;
+		}
+	}
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+	std::lock_guard<std::mutex> guard(toggleLock); //So that two threads can't both start or both stop (and write) the same trace
+
+	if(_enabled == enabled)
+		return;
+
+	if(enabled)
+	{
+		{
+			std::lock_guard<std::mutex> buffersGuard(buffersLock);
+
+			for(auto & buffer : buffers)
+				buffer->recorded = 0; //Nothing is appended while disabled
+		}
+
+		_enabled = true;
+	}
+	else
+	{
+		stopRecording();
+		writeChromeTrace();
+	}
+}
+
+void Tracer::stopRecording()
+{
+	_enabled = false;
+
+	//An append that already saw it enabled is done once busy is cleared, any later one sees it is disabled
+	std::lock_guard<std::mutex> guard(buffersLock);
+
+	for(auto & buffer : buffers)
+		while(buffer->busy)
+			std::this_thread::yield();
+}
+
+void Tracer::record(char phase, const char * name, int64_t timestamp, int64_t value)
+{
+	TraceBuffer & buffer = threadBuffer();
+
+	buffer.busy = true; //Sequentially consistent, as is the check of _enabled after it, so stopRecording either waits for us or we see that it stopped
+
+	if(_enabled)
+		buffer.events[buffer.recorded++ & (TraceBuffer::capacity - 1)] = { name, phase, timestamp, value, buffer.threadId };
+
+	buffer.busy.store(false, std::memory_order_release);
+}
+
+int64_t Tracer::now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void Tracer::begin(const char * name)
+{
+	if(enabled())
+		record('B', name, now(), 0);
+}
+
+void Tracer::end(const char * name)
+{
+	if(enabled())
+		record('E', name, now(), 0);
+}
+
+void Tracer::complete(const char * name, int64_t start, int64_t duration)
+{
+	if(enabled())
+		record('X', name, start, duration);
+}
+
+void Tracer::count(const char * name, int64_t amount)
+{
+	if(enabled())
+		record('C', name, now(), amount);
+}
+
+void Tracer::writeChromeTrace(std::ostream & out)
+{
+	std::vector<TraceEvent> events;
+
+	{
+		std::lock_guard<std::mutex> guard(buffersLock);
+
+		for(auto & buffer : buffers)
+			for(size_t i = buffer->recorded > TraceBuffer::capacity ? buffer->recorded - TraceBuffer::capacity : 0; i < buffer->recorded; i++)
+				events.push_back(buffer->events[i & (TraceBuffer::capacity - 1)]);
+	}
+
+	//Counters are recorded as increments, but shown as running totals
+	std::stable_sort(events.begin(), events.end(), [](const TraceEvent & l, const TraceEvent & r) { return l.timestamp < r.timestamp; });
+
+	std::map<std::string, int64_t>	totals;
+	unsigned long					pid		= ProcessInfo::currentPID();
+	bool							first	= true;
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	for(const TraceEvent & event : events)
+	{
+		out << (first ? "\n" : ",\n") << "{\"name\":\"";
+		writeEscaped(out, event.name);
+		out << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.timestamp << ",\"pid\":" << pid << ",\"tid\":" << event.threadId;
+
+		switch(event.phase)
+		{
+		case 'X':	out << ",\"dur\":" << event.value;	break;
+		case 'C':	out << ",\"args\":{\"total\":" << (totals[event.name] += event.value) << "}"; break;
+		default:	break;
+		}
+
+		out << "}";
+		first = false;
+	}
+
+	out << "\n]}\n";
+}
+
+void Tracer::writeChromeTrace()
+{
+	if(_outputFile == "")
+		return;
+
+	boost::nowide::ofstream out(_outputFile.c_str(), std::ios_base::out | std::ios_base::trunc);
+
+	if(out.fail())
+	{
+		Log::log() << "Could not open \"" << _outputFile << "\" to write the trace to." << std::endl;
+		return;
+	}
+
+	writeChromeTrace(out);
+
+	Log::log() << "Trace written to \"" << _outputFile << "\"" << std::endl;
+}
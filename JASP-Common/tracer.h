@@ -0,0 +1,56 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+///Low-overhead tracing that is always compiled in and switched on at runtime (through the logCfg message for the engines).
+///Each thread records into its own ringbuffer without locking, so when it runs for a long time only the most recent events are kept.
+///When it gets switched off the events are written to a Chrome-trace file, which can be opened in chrome://tracing or ui.perfetto.dev.
+///All names passed in are expected to be string-literals, only the pointer is stored.
+class Tracer
+{
+public:
+	static bool		enabled() { return _enabled.load(std::memory_order_relaxed); }
+	static void		setEnabled(bool enabled);
+	static void		setOutputFile(const std::string & filePath) { _outputFile = filePath; }
+
+	static int64_t	now();
+	static void		begin(		const char * name);
+	static void		end(		const char * name);
+	static void		complete(	const char * name, int64_t start, int64_t duration);
+	static void		count(		const char * name, int64_t amount);
+
+	static void		writeChromeTrace(std::ostream & out); ///< Only while disabled, as that is when nothing gets appended
+	static void		writeChromeTrace();
+
+private:
+					Tracer() {}
+
+	static void		stopRecording();
+	static void		record(char phase, const char * name, int64_t timestamp, int64_t value);
+
+	static std::atomic<bool>	_enabled;
+	static std::string			_outputFile;
+};
+
+///Records the time between its construction and destruction as a single span.
+class TraceSpan
+{
+public:
+	TraceSpan(const char * name) : _name(Tracer::enabled() ? name : nullptr), _start(_name ? Tracer::now() : 0) {}
+	~TraceSpan() { if(_name) Tracer::complete(_name, _start, Tracer::now() - _start); }
+
+private:
+	const char	*	_name;
+	int64_t			_start;
+};
+
+#define JASPTRACE_CONCAT_(A, B)			A##B
+#define JASPTRACE_CONCAT(A, B)			JASPTRACE_CONCAT_(A, B)
+#define JASPTRACE_SCOPE(NAME)			TraceSpan JASPTRACE_CONCAT(_jaspTraceSpan, __LINE__)( #NAME )
+#define JASPTRACE_COUNT(NAME, AMOUNT)	do { if(Tracer::enabled()) Tracer::count( #NAME, int64_t(AMOUNT)); } while(0)
+
+#endif // TRACER_H
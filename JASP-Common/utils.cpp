@@ -25,6 +25,10 @@
 #endif
 
 #ifndef IGNORE_BOOST
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include <boost/filesystem.hpp>
@@ -262,6 +266,10 @@ const vector<string> Utils::_defaultEmptyValues = {"NaN", "nan", ".", "NA"};
 vector<double> Utils::_currentDoubleEmptyValues = {};
 vector<string> Utils::_currentEmptyValues = Utils::_defaultEmptyValues;
 
+std::unordered_set<string>	Utils::_emptyValueSet(Utils::_defaultEmptyValues.begin(), Utils::_defaultEmptyValues.end());
+uint64_t					Utils::_emptyValueLengths = Utils::_lengthsOf(Utils::_defaultEmptyValues);
+vector<double>				Utils::_sortedDoubleEmptyValues = {};
+
 void Utils::setEmptyValues(const vector<string> &emptyvalues)
 {
 	_currentEmptyValues = emptyvalues;
@@ -278,6 +286,47 @@ void Utils::processEmptyValues()
 		if (Utils::getDoubleValue(*it, doubleValue))
 			_currentDoubleEmptyValues.push_back(doubleValue);
 	}
+
+	_emptyValueSet				= std::unordered_set<string>(_currentEmptyValues.begin(), _currentEmptyValues.end());
+	_emptyValueLengths			= _lengthsOf(_currentEmptyValues);
+	_sortedDoubleEmptyValues.clear();
+
+	// "NaN" and "nan" parse to NaN, which isEmptyValue checks first anyway and which would break the ordering the binary search relies on
+	for (double value : _currentDoubleEmptyValues)
+		if (!std::isnan(value))
+			_sortedDoubleEmptyValues.push_back(value);
+
+	std::sort(_sortedDoubleEmptyValues.begin(), _sortedDoubleEmptyValues.end());
+}
+
+uint64_t Utils::_lengthsOf(const vector<string> &values)
+{
+	uint64_t lengths = 0;
+
+	for (const string & value : values)
+		lengths |= uint64_t(1) << std::min(value.length(), size_t(63));
+
+	return lengths;
+}
+
+bool Utils::isEmptyValue(const string &value)
+{
+	if (value.empty())
+		return true;
+
+	if ((_emptyValueLengths & (uint64_t(1) << std::min(value.length(), size_t(63)))) == 0)
+		return false;
+
+	return _emptyValueSet.count(value) > 0;
+}
+
+bool Utils::isEmptyValue(double value)
+{
+	// NaN never equals an empty value anyway, and it isn't ordered so it can't go into the binary search
+	if (std::isnan(value))
+		return true;
+
+	return std::binary_search(_sortedDoubleEmptyValues.begin(), _sortedDoubleEmptyValues.end(), value);
 }
 
 bool Utils::getIntValue(const string &value, int &intValue)
@@ -325,3 +374,15 @@ bool Utils::getDoubleValue(const string &value, double &doubleValue)
 	return success;
 }
 
+std::string Utils::doubleToString(double value)
+{
+	char buffer[32];
+	int length = snprintf(buffer, sizeof(buffer), "%g", value); // %g is what an ostream does with its default precision of 6
+
+	// snprintf follows the C-locale, which the GUI might have set to something with a decimal comma
+	char decimalPoint = *localeconv()->decimal_point;
+	if (decimalPoint != '.')
+		std::replace(buffer, buffer + length, decimalPoint, '.');
+
+	return std::string(buffer, length);
+}
@@ -20,6 +20,8 @@
 
 #include <string>
 #include <vector>
+#include <unordered_set>
+#include <cstdint>
 #include <boost/filesystem.hpp>
 #include "timers.h"
 
@@ -54,15 +56,24 @@ public:
 	static const std::vector<double>& getDoubleEmptyValues()		{ return _currentDoubleEmptyValues;	}
 	static void setEmptyValues(const std::vector<std::string>& emptyvalues);
 	static void processEmptyValues();
+	static bool isEmptyValue(const std::string& value);
+	static bool isEmptyValue(double value);
 
 	static bool getIntValue(const std::string& value, int& intValue);
 	static bool getIntValue(const double& value, int& intValue);
 	static bool getDoubleValue(const std::string& value, double& doubleValue);
+	static std::string doubleToString(double value); ///< Same as streaming it into a default std::ostream, but without building a stream each time.
 
 private:
 	static std::vector<std::string>			_currentEmptyValues;
 	static const std::vector<std::string>	_defaultEmptyValues;
 	static std::vector<double>				_currentDoubleEmptyValues;
+
+	// The empty values compiled for lookup by processEmptyValues, so isEmptyValue doesn't need to walk the lists for every cell.
+	static uint64_t							_lengthsOf(const std::vector<std::string>& values);
+	static std::unordered_set<std::string>	_emptyValueSet;
+	static uint64_t							_emptyValueLengths; ///< Bit n is set when an empty value has length n (63 stands for anything longer), most values get rejected without being hashed.
+	static std::vector<double>				_sortedDoubleEmptyValues;
 };
 
 #endif // UTILS_H
@@ -267,10 +267,12 @@ HEADERS += \
     data/datasettablemodel.h \
     data/fileevent.h \
     analysis/options/variableinfo.h \
+    engine/engineprocess.h \
     engine/enginerepresentation.h \
     engine/enginesync.h \
     engine/rscriptstore.h \
     qquick/datasetview.h \
+    qquick/datasetviewblock.h \
     modules/analysisentry.h \
     modules/dynamicmodule.h \
     modules/dynamicmodules.h \
@@ -292,6 +294,7 @@ HEADERS += \
     utilities/settings.h \
     utilities/simplecrypt.h \
     utilities/simplecryptkey.h \
+    utilities/unittestrunner.h \
     variablespage/labelfiltergenerator.h \
     variablespage/levelstablemodel.h \
     widgets/filemenu/filemenuobject.h \
@@ -472,6 +475,7 @@ SOURCES += \
     utilities/resultsjsinterface.cpp \
     utilities/settings.cpp \
     utilities/simplecrypt.cpp \
+    utilities/unittestrunner.cpp \
     variablespage/labelfiltergenerator.cpp \
     variablespage/levelstablemodel.cpp \
     widgets/filemenu/filemenuobject.cpp \
@@ -551,6 +555,11 @@ SOURCES += \
     gui/jaspversionchecker.cpp \
     widgets/listmodeltableviewbase.cpp
 
+linux {
+    HEADERS += engine/enginezygote.h
+    SOURCES += engine/enginezygote.cpp
+}
+
 RESOURCES += \
     html/html.qrc \
     resources/icons.qrc \
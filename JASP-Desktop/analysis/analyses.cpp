@@ -26,6 +26,7 @@
 
 #include <QFile>
 #include <QTimer>
+#include <sstream>
 
 
 #include "utils.h"
@@ -168,6 +169,7 @@ void Analyses::bindAnalysisHandler(Analysis* analysis)
 	connect(analysis, &Analysis::editImageSignal,					this, &Analyses::analysisEditImage					);
 	connect(analysis, &Analysis::imageSavedSignal,					this, &Analyses::analysisImageSaved					);
 	connect(analysis, &Analysis::rewriteImagesSignal,				this, &Analyses::analysisRewriteImages				);
+	connect(analysis, &Analysis::imageRewrittenSignal,				this, &Analyses::analysisImageRewritten				);
 	connect(analysis, &Analysis::imageEditedSignal,					this, &Analyses::analysisImageEdited				);
 	connect(analysis, &Analysis::requestColumnCreation,				this, &Analyses::requestColumnCreation				);
 	connect(analysis, &Analysis::resultsChangedSignal,				this, &Analyses::analysisResultsChanged				);
@@ -316,6 +318,7 @@ void Analyses::rescanAnalysisEntriesOfDynamicModule(Modules::DynamicModule * mod
 
 void Analyses::refreshAllAnalyses()
 {
+	_dataRevision++; //Filter changed or the user explicitly wants everything to be recalculated
 	for(auto idAnalysis : _analysisMap)
 		idAnalysis.second->refresh();
 }
@@ -328,6 +331,23 @@ void Analyses::refreshAllPlots(std::set<Analysis*> exceptThese)
 }
 
 
+std::string Analyses::columnRevision(const std::string & column) const
+{
+	//Syncs, renames and removals are counted here, label edits, type changes and computed values show up in the revisions of the column itself
+	std::stringstream revision;
+	revision << (_columnRevisions.count(column) > 0 ? _columnRevisions.at(column) : 0);
+
+	int index = _dataSet == nullptr ? -1 : _dataSet->getColumnIndex(column);
+
+	if(index != -1)
+	{
+		Column & col = _dataSet->column(index);
+		revision << "." << col.revision() << "." << col.labels().revision();
+	}
+
+	return revision.str();
+}
+
 void Analyses::refreshAnalysesUsingColumn(QString col)
 {
 	std::vector<std::string> changedColumns, missingColumns, oldNames;
@@ -362,6 +382,13 @@ void Analyses::refreshAnalysesUsingColumns(std::vector<std::string> &changedColu
 {
 	std::set<Analysis *> analysesToRefresh;
 
+	for (const std::vector<std::string> * columns : { &changedColumns, &missingColumns, &oldColumnNames })
+		for (const std::string & column : *columns)
+			_columnRevisions[column]++;
+
+	for (auto & oldNew : changeNameColumns)
+		_columnRevisions[oldNew.second]++;
+
 	for (auto idAnalysis : _analysisMap)
 	{
 		Analysis * analysis = idAnalysis.second;
@@ -494,6 +521,7 @@ void Analyses::selectAnalysis(Analysis * analysis)
 void Analyses::setDataSet(DataSet *dataSet)
 {
 	_dataSet = dataSet;
+	_dataRevision++;
 	
 	emit dataSetChanged();
 }
@@ -83,6 +83,10 @@ public:
 	Json::Value asJson() const;
 
 	void		selectAnalysis(Analysis * analysis);
+
+	///Revision stamps of the data, used by Analysis to know whether its cached results are still valid.
+	size_t		dataRevision()								const	{ return _dataRevision;															}
+	std::string	columnRevision(const std::string & column)	const;
 	
 	void		setDataSet(DataSet* dataSet);
 	DataSet*	getDataSet() const				{ return _dataSet; }
@@ -127,6 +131,7 @@ signals:
 	void analysisImageSaved(			Analysis *	source);
 	void analysisImageEdited(			Analysis *	source);
 	void analysisRewriteImages(			Analysis *	source);
+	void analysisImageRewritten(		Analysis *	source, QString plotName);
 	void analysisResultsChanged(		Analysis *	source);
 	void analysisTitleChanged(			Analysis *  source);
 	void analysisOptionsChanged(		Analysis *	source);
@@ -163,6 +168,8 @@ private:
 	 DynamicModules*				_dynamicModules			= nullptr;
 	 double							_currentFormHeight		= 0;
 	 bool							_visible				= false;
+	 size_t							_dataRevision			= 0;
+	 std::map<std::string, size_t>	_columnRevisions;
 
 	 static int								_scriptRequestID;
 	 QMap<int, QPair<Analysis*, QString> >	_scriptIDMap;
@@ -26,6 +26,7 @@
 #include "dirs.h"
 #include "analyses.h"
 #include "analysisform.h"
+#include "log.h"
 
 
 
@@ -68,6 +69,7 @@ Analysis::Analysis(Analyses* analyses, size_t id, Modules::AnalysisEntry * analy
 
 Analysis::~Analysis()
 {
+	TempFiles::deleteResultsCache(_id);
 	delete _options;
 }
 
@@ -111,6 +113,10 @@ void Analysis::setResults(const Json::Value & results, int progress)
 	_progress = progress;
 	if (_analysisForm)
 		_analysisForm->clearErrors();
+
+	if (_status == Complete)
+		storeResultsInCache();
+
 	emit resultsChangedSignal(this);
 }
 
@@ -142,6 +148,7 @@ void Analysis::refresh()
 	setStatus(Empty);
 	_revision++;
 	TempFiles::deleteAll(_id);
+	clearResultsCache();
 	emit toRefreshSignal(this);
 }
 
@@ -154,14 +161,16 @@ void Analysis::saveImage(const Json::Value &options)
 
 void Analysis::editImage(const Json::Value &options)
 {
+	clearResultsCache();
 	setStatus(Analysis::EditImg);
 	_saveImgOptions = options;
 	emit editImageSignal(this);
 }
 
+///The plots themselves are rewritten one by one by EngineSync, so they can be spread over all idle engines
 void Analysis::rewriteImages()
 {
-	setStatus(Analysis::RewriteImgs);
+	clearResultsCache();
 	emit rewriteImagesSignal(this);
 }
 
@@ -170,6 +179,37 @@ void Analysis::imagesRewritten()
 	emit resultsChangedSignal(this);
 }
 
+void Analysis::imageRewritten(const std::string & plotName)
+{
+	emit imageRewrittenSignal(this, QString::fromStdString(plotName));
+}
+
+std::vector<std::string> Analysis::plotNames() const
+{
+	std::vector<std::string> names;
+	collectPlotNames(_results, names);
+
+	return names;
+}
+
+void Analysis::collectPlotNames(const Json::Value & node, std::vector<std::string> & names)
+{
+	if(!node.isObject())
+		return;
+
+	//Tables also have a "data" member, but that is an array of rows instead of the (relative) path to the image
+	if(node["data"].isString() && node.isMember("width") && node.isMember("height"))
+	{
+		if(node["data"].asString() != "")
+			names.push_back(node["data"].asString());
+		return;
+	}
+
+	for(const std::string & name : node.getMemberNames())
+		if(name != ".meta")
+			collectPlotNames(node[name], names);
+}
+
 Analysis::Status Analysis::parseStatus(std::string name)
 {
 	if		(name == "empty")			return Analysis::Empty;
@@ -260,11 +300,89 @@ void Analysis::optionsChangedHandler(Option *option)
 	if (_refreshBlocked)
 		return;
 
+	bool notOnAnEngine = _status != Initing && _status != Running && _status != Aborting; //Otherwise the engine still needs to be told to abort
+
 	_status = Empty;
 	_revision++;
+
+	if (notOnAnEngine && restoreResultsFromCache())
+		return;
+
 	optionsChanged(this);
 }
 
+std::string Analysis::resultsCacheKey()
+{
+	// An analysis that creates columns has to run to fill them, restoring only its results would leave the columns with the data of its last run
+	if (options()->size() == 0 || columnsCreated().size() > 0)
+		return "";
+
+	std::stringstream key;
+	key << Json::FastWriter().write(options()->asJSON()) << "data:" << _analyses->dataRevision();
+
+	for (const std::string & column : usedVariables())
+		key << "\n" << column << ":" << _analyses->columnRevision(column);
+
+	return key.str();
+}
+
+void Analysis::storeResultsInCache()
+{
+	std::string key = resultsCacheKey();
+
+	if (key == "")
+		return;
+
+	size_t hash = std::hash<std::string>()(key);
+
+	if (_resultsCache.count(hash) == 0)
+	{
+		_resultsCacheOrder.push_back(hash);
+
+		if (_resultsCacheOrder.size() > _resultsCacheMax)
+		{
+			TempFiles::deleteResultsCache(_id, std::to_string(_resultsCacheOrder.front()));
+			_resultsCache.erase(_resultsCacheOrder.front());
+			_resultsCacheOrder.pop_front();
+		}
+	}
+
+	_resultsCache[hash] = { key, _results };
+	TempFiles::copyToResultsCache(_id, std::to_string(hash), plotNames());
+}
+
+bool Analysis::restoreResultsFromCache()
+{
+	std::string	key		= resultsCacheKey();
+	size_t		hash	= std::hash<std::string>()(key);
+
+	if (key == "" || _resultsCache.count(hash) == 0 || _resultsCache[hash].key != key || !TempFiles::restoreFromResultsCache(_id, std::to_string(hash)))
+		return false;
+
+	Log::log() << "Analysis " << _id << " restored its results from the cache instead of rerunning." << std::endl;
+
+	setStatus(Complete);
+	_results	= _resultsCache[hash].results;
+	_progress	= -1;
+
+	if (_results.isObject() && _results.isMember("title"))
+		_results["title"] = _title;
+
+	if (_analysisForm)
+		_analysisForm->clearErrors();
+
+	emit resultsChangedSignal(this);
+
+	return true;
+}
+
+void Analysis::clearResultsCache()
+{
+	_resultsCache.clear();
+	_resultsCacheOrder.clear();
+	TempFiles::deleteResultsCache(_id);
+}
+
 
 int Analysis::callback(Json::Value results)
 {
@@ -352,6 +470,28 @@ Json::Value Analysis::createAnalysisRequestJson(int ppi, std::string imageBackgr
 	return json;
 }
 
+///Unlike createAnalysisRequestJson this does not touch the status, the analysis stays finished while its plots are being rewritten.
+Json::Value Analysis::createPlotRewriteRequestJson(const std::string & plotName, int ppi, std::string imageBackground) const
+{
+	Json::Value json = Json::Value(Json::objectValue);
+
+	json["typeRequest"]			= engineStateToString(engineState::analysis);
+	json["id"]					= int(id());
+	json["perform"]				= performTypeToString(performType::rewriteImgs);
+	json["revision"]			= revision();
+	json["rfile"]				= _moduleData == nullptr ? rfile() : "";
+	json["jaspResults"]			= usesJaspResults();
+	json["dynamicModuleCall"]	= _moduleData == nullptr ? "" : _moduleData->getFullRCall();
+	json["name"]				= name();
+	json["title"]				= title();
+	json["ppi"]					= ppi;
+	json["imageBackground"]		= imageBackground;
+	json["image"]				= Json::objectValue;
+	json["image"]["plot"]		= plotName;
+
+	return json;
+}
+
 void Analysis::setName(std::string name)
 {
 	if (_name == name)
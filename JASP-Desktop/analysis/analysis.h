@@ -27,6 +27,7 @@
 #include "enginedefinitions.h"
 
 #include <set>
+#include <deque>
 #include <QObject>
 #include "modules/dynamicmodules.h"
 
@@ -69,6 +70,7 @@ signals:
 	void				imageSavedSignal(		Analysis * analysis);
 	void				imageEditedSignal(		Analysis * analysis);
 	void				rewriteImagesSignal(	Analysis * analysis);
+	void				imageRewrittenSignal(	Analysis * analysis, QString plotName);
 	void				resultsChangedSignal(	Analysis * analysis);
 
 	ComputedColumn *	requestComputedColumnCreation(		QString columnName, Analysis * analysis);
@@ -92,6 +94,7 @@ public:
 	void imageEdited(	const Json::Value & results);
 	void rewriteImages();
 	void imagesRewritten();
+	void imageRewritten(const std::string & plotName);
 
 	void setRFile(const std::string &file)				{ _rfile = file;								}
 	void setUserData(Json::Value userData)				{ _userData = userData;							}
@@ -130,6 +133,8 @@ public:
 			Json::Value asJSON()		const;
 			void		loadFromJSON(Json::Value & options);
 			Json::Value createAnalysisRequestJson(int ppi, std::string imageBackground);
+			Json::Value createPlotRewriteRequestJson(const std::string & plotName, int ppi, std::string imageBackground) const;
+			std::vector<std::string> plotNames() const;
 
 	static	Status		parseStatus(std::string name);
 
@@ -166,6 +171,11 @@ protected:
 
 private:
 	void					optionsChangedHandler(Option *option = nullptr);
+	std::string				resultsCacheKey();
+	void					storeResultsInCache();
+	bool					restoreResultsFromCache();
+	void					clearResultsCache();
+	static void				collectPlotNames(const Json::Value & node, std::vector<std::string> & names);
 	ComputedColumn *		requestComputedColumnCreationHandler(std::string columnName)		{ return requestComputedColumnCreation(QString::fromStdString(columnName), this); }
 	void					requestColumnCreationHandler(std::string columnName, int colType)	{ return requestColumnCreation(QString::fromStdString(columnName), this, colType); }
 	void					requestComputedColumnDestructionHandler(std::string columnName)		{ requestComputedColumnDestruction(QString::fromStdString(columnName)); }
@@ -202,6 +212,17 @@ private:
 
 	std::string				_codedReferenceToAnalysisEntry = "";
 	QString					_helpFile;
+
+	///Results of earlier completed runs, keyed by a hash of their options and the revisions of the data they used. Their plots and state are stored by TempFiles.
+	struct ResultsCacheEntry
+	{
+		std::string	key;
+		Json::Value	results;
+	};
+
+	std::map<size_t, ResultsCacheEntry>	_resultsCache;
+	std::deque<size_t>					_resultsCacheOrder;
+	static const size_t					_resultsCacheMax = 10;
 };
 
 #endif // ANALYSIS_H
@@ -62,7 +62,7 @@ Terms::Terms(Terms *parent)
 
 void Terms::set(const std::vector<Term> &terms)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term);
@@ -70,7 +70,7 @@ void Terms::set(const std::vector<Term> &terms)
 
 void Terms::set(const std::vector<string> &terms)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term);
@@ -78,7 +78,7 @@ void Terms::set(const std::vector<string> &terms)
 
 void Terms::set(const std::vector<std::vector<string> > &terms)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term);
@@ -86,7 +86,7 @@ void Terms::set(const std::vector<std::vector<string> > &terms)
 
 void Terms::set(const QList<Term> &terms)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term);
@@ -94,7 +94,7 @@ void Terms::set(const QList<Term> &terms)
 
 void Terms::set(const Terms &terms)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term);
@@ -102,7 +102,7 @@ void Terms::set(const Terms &terms)
 
 void Terms::set(const QList<QList<QString> > &terms)
 {
-	_terms.clear();
+	clear();
 
 	for(const QList<QString> &term : terms)
 		add(Term(term));
@@ -110,7 +110,7 @@ void Terms::set(const QList<QList<QString> > &terms)
 
 void Terms::set(const QList<QString> &terms)
 {
-	_terms.clear();
+	clear();
 
 	for(const QString &term : terms)
 		add(Term(term));
@@ -140,14 +140,34 @@ void Terms::add(const Term &term)
 		}
 
 		if (result > 0)
+		{
 			_terms.insert(itr, term);
+			_componentIndexValid = false;
+
+			if (_membershipValid)
+				_membership.insert(membershipKey(term));
+		}
 		else if (result < 0)
+		{
 			_terms.push_back(term);
+
+			if (_componentIndexValid && !_componentIndex.contains(term.asQString()))
+				_componentIndex.insert(term.asQString(), int(_terms.size()) - 1);
+
+			if (_membershipValid)
+				_membership.insert(membershipKey(term));
+		}
 	}
 	else
 	{
 		if ( ! contains(term))
+		{
 			_terms.push_back(term);
+			_membership.insert(membershipKey(term)); //contains() just made sure it is valid
+
+			if (_componentIndexValid && !_componentIndex.contains(term.asQString()))
+				_componentIndex.insert(term.asQString(), int(_terms.size()) - 1);
+		}
 	}
 }
 
@@ -161,6 +181,7 @@ void Terms::insert(int index, const Term &term)
 			itr++;
 
 		_terms.insert(itr, term);
+		termsChanged();
 	}
 	else
 	{
@@ -178,6 +199,7 @@ void Terms::insert(int index, const Terms &terms)
 			itr++;
 
 		_terms.insert(itr, terms.begin(), terms.end());
+		termsChanged();
 	}
 	else
 	{
@@ -198,7 +220,38 @@ const Term& Terms::at(size_t index) const
 
 bool Terms::contains(const Term &term) const
 {
-	return std::find(_terms.begin(), _terms.end(), term) != _terms.end();
+	if (!_membershipValid)
+	{
+		_membership.clear();
+		_membership.reserve(_terms.size());
+
+		for (const Term &existing : _terms)
+			_membership.insert(membershipKey(existing));
+
+		_membershipValid = true;
+	}
+
+	return _membership.count(membershipKey(term)) > 0;
+}
+
+string Terms::membershipKey(const Term &term)
+{
+	// Terms are equal when their components are, joined with a character that doesn't show up in a column name
+	string key;
+
+	for (const string &component : term.scomponents())
+	{
+		key.append(component);
+		key.push_back('\0');
+	}
+
+	return key;
+}
+
+void Terms::termsChanged()
+{
+	_membershipValid		= false;
+	_componentIndexValid	= false;
 }
 
 bool Terms::contains(const string component)
@@ -414,21 +467,29 @@ Term Terms::sortComponents(const Term &term) const
 	return Term(components);
 }
 
-int Terms::rankOf(const QString &component) const
+int Terms::indexOfComponent(const QString &component) const
 {
-	if (_parent == NULL)
-		return 0;
+	if (!_componentIndexValid)
+	{
+		_componentIndex.clear();
+		_componentIndex.reserve(int(_terms.size()));
 
-	int index = 0;
+		for (size_t i = 0; i < _terms.size(); i++)
+			if (!_componentIndex.contains(_terms[i].asQString()))
+				_componentIndex.insert(_terms[i].asQString(), int(i));
 
-	for(const Term& compare : _parent->terms())
-	{
-		if (compare.asQString() == component)
-			break;
-		index++;
+		_componentIndexValid = true;
 	}
 
-	return index;
+	return _componentIndex.value(component, int(_terms.size()));
+}
+
+int Terms::rankOf(const QString &component) const
+{
+	if (_parent == NULL)
+		return 0;
+
+	return _parent->indexOfComponent(component);
 }
 
 int Terms::termCompare(const Term &t1, const Term &t2) const
@@ -473,6 +534,8 @@ void Terms::remove(const Terms &terms)
 		if (itr != _terms.end())
 			_terms.erase(itr);
 	}
+
+	termsChanged();
 }
 
 void Terms::remove(size_t pos, size_t n)
@@ -484,6 +547,8 @@ void Terms::remove(size_t pos, size_t n)
 
 	for (; n > 0 && itr != _terms.end(); n--)
 		_terms.erase(itr);
+
+	termsChanged();
 }
 
 bool Terms::discardWhatDoesntContainTheseComponents(const Terms &terms)
@@ -512,6 +577,8 @@ bool Terms::discardWhatDoesntContainTheseComponents(const Terms &terms)
 		_terms.end()
 	);
 
+	termsChanged();
+
 	return changed;
 }
 
@@ -544,6 +611,8 @@ bool Terms::discardWhatDoesContainTheseComponents(const Terms &terms)
 		_terms.end()
 	);
 
+	termsChanged();
+
 	return changed;
 }
 
@@ -573,6 +642,8 @@ bool Terms::discardWhatDoesContainTheseTerms(const Terms &terms)
 		_terms.end()
 	);
 
+	termsChanged();
+
 	return changed;
 }
 
@@ -599,12 +670,15 @@ bool Terms::discardWhatIsntTheseTerms(const Terms &terms, Terms *discarded)
 		_terms.end()
 	);
 
+	termsChanged();
+
 	return changed;
 }
 
 void Terms::clear()
 {
 	_terms.clear();
+	termsChanged();
 }
 
 size_t Terms::size() const
@@ -631,6 +705,9 @@ void Terms::remove(const Term &term)
 {
 	vector<Term>::iterator itr = std::find(_terms.begin(), _terms.end(), term);
 	if (itr != end())
+	{
 		_terms.erase(itr);
+		termsChanged();
+	}
 }
 
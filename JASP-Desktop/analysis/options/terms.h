@@ -22,9 +22,11 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <unordered_set>
 
 #include <QString>
 #include <QList>
+#include <QHash>
 #include <QByteArray>
 
 #include "term.h"
@@ -101,14 +103,23 @@ public:
 
 private:
 
+	int		indexOfComponent(const QString &component)				const;
 	int		rankOf(const QString &component)						const;
 	int		termCompare(const Term& t1, const Term& t2)				const;
 	bool	termLessThan(const Term &t1, const Term &t2)			const;
 	bool	componentLessThan(const QString &c1, const QString &c2)	const;
 
+	static std::string	membershipKey(const Term &term);
+	void				termsChanged();
+
 	const Terms *_parent;
 	std::vector<Term> _terms;
 
+	// Both are built on demand and thrown away whenever _terms changes in a way that can't be followed cheaply
+	mutable std::unordered_set<std::string>	_membership;		///< membershipKey of every term, for contains(const Term&)
+	mutable bool							_membershipValid	= false;
+	mutable QHash<QString, int>				_componentIndex;	///< Position of every term by its asQString, this is what rankOf in the children looks up
+	mutable bool							_componentIndexValid	= false;
 
 };
 
@@ -235,10 +235,21 @@ ScrollView
 						margins:	Theme.generalAnchorMargin
 						left:		maxLogFilesSpinBox.right
 					}
-					KeyNavigation.tab:	uiScaleSpinBox
-					KeyNavigation.down:	uiScaleSpinBox
+					KeyNavigation.tab:	traceToFile
+					KeyNavigation.down:	traceToFile
 				}
 			}
+
+			CheckBox
+			{
+				id:					traceToFile
+				label:				qsTr("Trace to file")
+				checked:			preferencesModel.traceToFile
+				onCheckedChanged:	preferencesModel.traceToFile = checked
+				toolTip:			qsTr("To record a timeline of what JASP and its engines are doing, check this box. It is written next to the logs when unchecked or when JASP closes and can be opened in chrome://tracing.")
+				KeyNavigation.tab:	uiScaleSpinBox
+				KeyNavigation.down:	uiScaleSpinBox
+			}
 		}
 
 		Item
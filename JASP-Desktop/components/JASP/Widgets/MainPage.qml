@@ -254,6 +254,7 @@ Item
 					function pushImageToClipboard(raw, coded)		{ resultsJsInterface.pushImageToClipboard(raw, coded)		}
 					function saveTempImage(index, path, base64)		{ resultsJsInterface.saveTempImage(index, path, base64)		}
 					function getImageInBase64(index, path)			{ resultsJsInterface.getImageInBase64(index, path)			}
+					function visiblePlotsChanged(plotNames)			{ resultsJsInterface.visiblePlotsChanged(plotNames)			}
 					function resultsDocumentChanged()				{ resultsJsInterface.resultsDocumentChanged()				}
 					function displayMessageFromResults(msg)			{ resultsJsInterface.displayMessageFromResults(msg)			}
 					function setAllUserDataFromJavascript(json)		{ resultsJsInterface.setAllUserDataFromJavascript(json)		}
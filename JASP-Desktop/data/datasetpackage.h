@@ -32,13 +32,13 @@
 
 class DataSetPackage
 {
-	typedef std::map<std::string, std::map<int, std::string>> emptyValsType;
+	typedef std::map<std::string, ColumnEmptyValues> emptyValsType;
 
 public:
 			DataSetPackage();
 
 			void				reset();
-			void				storeInEmptyValues(std::string columnName, std::map<int, std::string> emptyValues)	{ _emptyValuesMap[columnName] = emptyValues;	}
+			void				storeInEmptyValues(std::string columnName, ColumnEmptyValues emptyValues)			{ _emptyValuesMap[columnName] = std::move(emptyValues);			}
 			void				resetEmptyValues()																	{ _emptyValuesMap.clear();											}
 
 			std::string			id()								const	{ return _id;							}
@@ -56,6 +56,7 @@ public:
 	const	std::string		&	warningMessage()					const	{ return _warningMessage;					   }
 	const	Version			&	archiveVersion()					const	{ return _archiveVersion;						}
 	const	emptyValsType	&	emptyValuesMap()					const	{ return _emptyValuesMap;						 }
+			emptyValsType	&	emptyValuesMap()									{ return _emptyValuesMap;						 }
 			bool				dataFileReadOnly()					const	{ return _dataFileReadOnly;						  }
 			uint				dataFileTimestamp()					const	{ return _dataFileTimestamp;					   }
 	const	Version			&	dataArchiveVersion()				const	{ return _dataArchiveVersion;						}
@@ -135,6 +135,45 @@ QVariant DataSetTableModel::data(const QModelIndex &index, int role) const
 	return returnThis;
 }
 
+///Gives the same as data() does for the DisplayRole, active and lines, but for a whole block of cells and with the labels of each column looked up only once
+void DataSetTableModel::dataBlock(int rowFirst, int rowLast, int colFirst, int colLast, DataSetViewBlock & block) const
+{
+	block.resize(rowFirst, rowLast, colFirst, colLast);
+
+	if (_dataSet == nullptr || _dataSet->synchingData())
+		return;
+
+	JASPTIMER_RESUME(DataSetTableModel::dataBlock);
+
+	auto &	filter	= _dataSet->filterVector();
+	int		rows	= rowCount(),
+			cols	= columnCount();
+
+	rowFirst = std::max(0, rowFirst);
+	colFirst = std::max(0, colFirst);
+
+	for(int col=colFirst; col<=colLast && col<cols; col++)
+	{
+		std::vector<std::string> values = _dataSet->column(col).displayValues(rowFirst, rowLast - rowFirst + 1);
+
+		for(int row=rowFirst; row<=rowLast && row<rows && size_t(row - rowFirst)<values.size(); row++)
+		{
+			size_t	cell			= block.index(row, col);
+			bool	iAmActive		= filter[row],
+					belowMeIsActive	= row < rows - 1 && filter[row + 1];
+
+			block.text[cell]	= tq(values[row - rowFirst]);
+			block.active[cell]	= iAmActive;
+			block.lines[cell]	=	(iAmActive ?						1 : 0) + //left
+									(iAmActive && col == cols - 1 ?		2 : 0) + //right
+									(iAmActive ?						4 : 0) + //up
+									(iAmActive && !belowMeIsActive ?	8 : 0);  //down
+		}
+	}
+
+	JASPTIMER_STOP(DataSetTableModel::dataBlock);
+}
+
 QVariant DataSetTableModel::columnTitle(int column) const
 {
 	if(_dataSet != nullptr && column >= 0 && size_t(column) < _dataSet->columnCount())
@@ -190,7 +229,10 @@ int DataSetTableModel::columnsFilteredCount()
 void DataSetTableModel::resetAllFilters()
 {
 	for(auto & col : _dataSet->columns())
+	{
+		_dataSet->preserveForSnapshots(col);
 		col.resetFilter();
+	}
 
 	emit allFiltersReset();
 	emit columnsFilteredCountChanged();
@@ -214,16 +256,37 @@ int DataSetTableModel::getMaximumColumnWidthInCharacters(size_t columnIndex) con
 		return 0;
 
 	default:
-	{
-		int tempVal = 0;
+		return col.labels().maxLabelLength() + extraPad;
+	}
 
-		for(size_t labelIndex=0; labelIndex < col.labels().size(); labelIndex++)
-			tempVal = std::max(tempVal, (int)col.labels().getLabelFromRow(labelIndex).length());
+}
 
-		return tempVal + extraPad;
-	}
-	}
+QString DataSetTableModel::maxColString(int column) const
+{
+	QString dummyText = headerData(column, Qt::Horizontal, Qt::DisplayRole).toString() + "XXXXX" + (isComputedColumn(column) ? "XXXXX" : ""); //Bit of padding for filtersymbol and columnIcon
+	int colWidth = getMaximumColumnWidthInCharacters(column);
+
+	if(colWidth > dummyText.length())
+		dummyText.append(QString(colWidth - dummyText.length(), 'X'));
+
+	return dummyText;
+}
+
+///All the maxColStrings from colFirst up to and including colLast in one go, so that DataSetView can measure many columns without a headerData-call for each of them.
+QStringList DataSetTableModel::maxColStrings(int colFirst, int colLast) const
+{
+	QStringList strings;
 
+	if (_dataSet == nullptr)
+		return strings;
+
+	colFirst	= std::max(0, colFirst);
+	colLast		= std::min(columnCount() - 1, colLast);
+
+	for(int col=colFirst; col<=colLast; col++)
+		strings.append(maxColString(col));
+
+	return strings;
 }
 
 QVariant DataSetTableModel::headerData ( int section, Qt::Orientation orientation, int role) const
@@ -244,16 +307,7 @@ QVariant DataSetTableModel::headerData ( int section, Qt::Orientation orientatio
 		}
 	}
 	else if(role == (int)specialRoles::maxColString) //A query from DataSetView for the maximumlength string to be expected! This to accomodate columnwidth
-	{
-		//calculate some maximum string?
-		QString dummyText = headerData(section, orientation, Qt::DisplayRole).toString() + "XXXXX" + (isComputedColumn(section) ? "XXXXX" : ""); //Bit of padding for filtersymbol and columnIcon
-		int colWidth = getMaximumColumnWidthInCharacters(section);
-
-		while(colWidth > dummyText.length())
-			dummyText += "X";
-
-		return dummyText;
-	}
+		return maxColString(section);
 	else if(role == Qt::TextAlignmentRole)							return QVariant(Qt::AlignCenter);
 	else if(role == (int)specialRoles::columnIsComputed)			return isComputedColumn(section);
 	else if(role == (int)specialRoles::computedColumnIsInvalidated)	return isComputedColumnInvalided(section);
@@ -315,6 +369,8 @@ bool DataSetTableModel::setColumnType(int columnIndex, Column::ColumnType newCol
 	if (_dataSet == nullptr)
 		return true;
 
+	_dataSet->preserveForSnapshots(_dataSet->column(columnIndex));
+
 	bool changed = _dataSet->column(columnIndex).changeColumnType(newColumnType);
 	emit headerDataChanged(Qt::Horizontal, columnIndex, columnIndex);
 
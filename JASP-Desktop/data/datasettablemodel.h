@@ -25,9 +25,10 @@
 
 #include "common.h"
 #include "datasetpackage.h"
+#include "qquick/datasetviewblock.h"
 
 
-class DataSetTableModel : public QAbstractTableModel
+class DataSetTableModel : public QAbstractTableModel, public DataSetViewBlockSource
 {
     Q_OBJECT
 	Q_PROPERTY(int columnsFilteredCount READ columnsFilteredCount NOTIFY columnsFilteredCountChanged)
@@ -45,6 +46,7 @@ public:
 				QVariant			headerData ( int section, Qt::Orientation orientation, int role = Qt::DisplayRole )	const	override;
 				bool				setData(const QModelIndex &index, const QVariant &value, int role)							override;
 				Qt::ItemFlags		flags(const QModelIndex &index)														const	override;
+				void				dataBlock(int rowFirst, int rowLast, int colFirst, int colLast, DataSetViewBlock & block)	const	override;
 
 	Q_INVOKABLE bool				isColumnNameFree(QString name)						{ return _package->isColumnNameFree(name.toStdString()); }
 	Q_INVOKABLE bool				getRowFilter(int row)					const		{ return (row >=0 && row < rowCount()) ? _dataSet->filterVector()[row] : true; }
@@ -55,6 +57,7 @@ public:
 	Q_INVOKABLE bool				columnUsedInEasyFilter(int column)		const;
 	Q_INVOKABLE void				resetAllFilters();
 	Q_INVOKABLE int					setColumnTypeFromQML(int columnIndex, int newColumnType);
+	Q_INVOKABLE QStringList			maxColStrings(int colFirst, int colLast)	const;
 
 				void				setDataSetPackage(DataSetPackage *package);
 				void				clearDataSet() { setDataSetPackage(NULL); }
@@ -83,6 +86,8 @@ public slots:
 				void				setColumnsUsedInEasyFilter(std::set<std::string> usedColumns);
     
 private:
+				QString				maxColString(int column)					const;
+
 	DataSet						*_dataSet;
 	DataSetPackage				*_package;
 	std::map<std::string, bool> columnNameUsedInEasyFilter;
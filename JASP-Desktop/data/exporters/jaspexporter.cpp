@@ -21,6 +21,12 @@
 #include <boost/filesystem.hpp>
 
 #include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <future>
+#include <thread>
 
 #include "dataset.h"
 
@@ -33,10 +39,102 @@
 #include "appinfo.h"
 
 
-const Version JASPExporter::dataArchiveVersion = Version("1.0.2");
-const Version JASPExporter::jaspArchiveVersion = Version("3.1.0");
+const Version		JASPExporter::dataArchiveVersion	= Version("2.1.0");
+const Version		JASPExporter::jaspArchiveVersion	= Version("3.1.0");
+const size_t		JASPExporter::dataRowsPerChunk		= 1 << 16;
+const std::string	JASPExporter::dataIndexEntryName	= "data.index";
+const std::string	JASPExporter::emptyValuesEntryName	= "emptyValues.bin";
 
 
+///Produces the contents of the entries on other threads, a few at a time, and writes them into the archive in the order they were added.
+///Deflating stays on the calling thread because libarchive only has one zip writer per archive, but reading and serializing entries does not.
+///What is underway is limited in number as well as in bytes, so saving a large data set doesn't need much more memory than a few columns.
+class JASPExporter::EntryPipeline
+{
+public:
+	struct Entry
+	{
+		std::string	name,
+					contents;
+		bool		store; ///< Written without compression, for files that are compressed already
+	};
+
+	typedef std::vector<Entry>				Entries;
+	typedef std::function<Entries()>		Producer;
+	typedef std::function<void()>			Written;
+
+	static const size_t maxPendingBytes = 256 << 20;
+
+	EntryPipeline(archive *a) : _archive(a), _maxPending(std::max(2u, 2 * std::thread::hardware_concurrency())) {}
+
+	///bytes is about how much the entries produced will take, written is called once they are in the archive.
+	void add(Producer produce, size_t bytes, Written written = nullptr)
+	{
+		makeRoomFor(bytes);
+		_pending.push_back({ std::async(std::launch::async, produce), bytes, written });
+		_pendingBytes += bytes;
+	}
+
+	void add(const std::string &name, std::string contents, bool store = false)
+	{
+		size_t	bytes = contents.size();
+		Entries	entries;
+		entries.push_back({ name, std::move(contents), store });
+
+		makeRoomFor(bytes);
+
+		std::promise<Entries> produced;
+		produced.set_value(std::move(entries));
+
+		_pending.push_back({ produced.get_future(), bytes, nullptr });
+		_pendingBytes += bytes;
+	}
+
+	///Writes everything added so far
+	void flush()
+	{
+		while (_pending.size() > 0)
+			writeFront();
+	}
+
+private:
+	struct Pending
+	{
+		std::future<Entries>	entries;
+		size_t					bytes;
+		Written					written;
+	};
+
+	void makeRoomFor(size_t bytes)
+	{
+		while (_pending.size() > 0 && (_pending.size() >= _maxPending || _pendingBytes + bytes > maxPendingBytes))
+			writeFront();
+	}
+
+	void writeFront()
+	{
+		Pending pending = std::move(_pending.front());
+		_pending.pop_front();
+
+		{
+			Entries entries = pending.entries.get(); //Rethrows whatever went wrong while producing them
+
+			for (const Entry & entry : entries)
+				writeEntry(_archive, entry.name, entry.contents.data(), entry.contents.size(), entry.store);
+		}
+
+		_pendingBytes -= pending.bytes;
+
+		if (pending.written)
+			pending.written();
+	}
+
+	archive				*	_archive;
+	size_t					_maxPending,
+							_pendingBytes = 0;
+	std::deque<Pending>		_pending;
+};
+
 JASPExporter::JASPExporter() {
 	_defaultFileType = Utils::jasp;
     _allowedFileTypes.push_back(Utils::jasp);
@@ -58,8 +156,14 @@ void JASPExporter::saveDataSet(const std::string &path, DataSetPackage* package,
 	if (errorCode != ARCHIVE_OK)
 		throw std::runtime_error("File could not be opened.");
 
-	saveDataArchive(a, package, progressCallback);
-	saveJASPArchive(a, package, progressCallback);
+	{
+		EntryPipeline pipeline(a);
+
+		saveDataArchive(pipeline, package, progressCallback);
+		saveJASPArchive(pipeline, package, progressCallback);
+
+		pipeline.flush();
+	}
 
 	errorCode = archive_write_close(a);
 	if (errorCode != ARCHIVE_OK)
@@ -71,11 +175,9 @@ void JASPExporter::saveDataSet(const std::string &path, DataSetPackage* package,
 }
 
 
-void JASPExporter::saveDataArchive(archive *a, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback)
+void JASPExporter::saveDataArchive(EntryPipeline &pipeline, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback)
 {
-	createJARContents(a);
-
-	struct archive_entry *entry;
+	pipeline.add("META-INF/MANIFEST.MF", createJARContents());
 
 	DataSet *dataset = package->dataSet();
 
@@ -102,26 +204,9 @@ void JASPExporter::saveDataArchive(archive *a, DataSetPackage *package, boost::f
 	dataSet["rowCount"]					= Json::Value(dataset ? int(dataset->rowCount())    : 0);
 	dataSet["columnCount"]				= Json::Value(dataset ? int(dataset->columnCount()) : 0);
 
-	dataSet["emptyValuesMap"]			= Json::objectValue;
-
-	for (auto it : package->emptyValuesMap())
-	{
-		std::string colName		= it.first;
-		auto		map			= it.second;
-		Json::Value mapJson		= Json::objectValue;
-
-		for (auto it2 : map)
-			mapJson[std::to_string(it2.first)] = it2.second;
-
-		dataSet["emptyValuesMap"][colName] = mapJson;
-	}
-
-
 	Json::Value columnsData = Json::arrayValue;
 
-	//Calculate size of data file that'll be added to the archive
-	size_t	dataSize	= 0,
-			columnCount	= dataset ? dataset->columnCount() : 0;
+	size_t columnCount = dataset ? dataset->columnCount() : 0;
 
 	for (size_t i = 0; i < columnCount; i++)
 	{
@@ -131,16 +216,7 @@ void JASPExporter::saveDataArchive(archive *a, DataSetPackage *package, boost::f
 		columnMetaData["name"]			= Json::Value(name);
 		columnMetaData["measureType"]	= Json::Value(getColumnTypeName(column.columnType()));
 
-		if (column.columnType()			!= Column::ColumnTypeScale)
-		{
-			columnMetaData["type"] = Json::Value("integer");
-			dataSize += sizeof(int) * dataset->rowCount();
-		}
-		else
-		{
-			columnMetaData["type"] = Json::Value("number");
-			dataSize += sizeof(double) * dataset->rowCount();
-		}
+		columnMetaData["type"]			= Json::Value(column.columnType() != Column::ColumnTypeScale ? "integer" : "number");
 
 
 		if (column.columnType() != Column::ColumnTypeScale)
@@ -187,184 +263,207 @@ void JASPExporter::saveDataArchive(archive *a, DataSetPackage *package, boost::f
 	}
 	dataSet["fields"]		= columnsData;
 
-	//Create new entry for archive
-	std::string metaDataString	= metaData.toStyledString();
-	size_t sizeOfMetaData		= metaDataString.size();
-	entry						= archive_entry_new();
-	std::string dd2				= std::string("metadata.json");
+	pipeline.add("metadata.json",	metaData.toStyledString());
+	pipeline.add("xdata.json",		labelsData.toStyledString());
 
-	archive_entry_set_pathname(entry, dd2.c_str());
-	archive_entry_set_size(entry, int(sizeOfMetaData));
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); // Not sure what this does
-	archive_write_header(a, entry);
 
-	archive_write_data(a, metaDataString.c_str(), sizeOfMetaData);
+	//Each column is stored in chunks that are compressed separately, the index after them lists them all with their checksums.
+	//The columns are copied and checksummed on other threads, each filling in its own part of chunks.
+	size_t					rowCount		= dataset ? dataset->rowCount() : 0,
+							columnChunks	= (rowCount + dataRowsPerChunk - 1) / dataRowsPerChunk;
+	std::vector<DataChunk>	chunks(columnCount * columnChunks);
 
-	archive_entry_free(entry);
-
-
-	//Create new entry for archive
-	std::string labelDataString = labelsData.toStyledString();
-	size_t		sizeOflabelData = labelDataString.size();
-
-	entry = archive_entry_new();
-	std::string dd9 = std::string("xdata.json");
-	archive_entry_set_pathname(entry, dd9.c_str());
-	archive_entry_set_size(entry, int(sizeOflabelData));
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); // Not sure what this does
-	archive_write_header(a, entry);
-
-	archive_write_data(a, labelDataString.c_str(), sizeOflabelData);
+	for (size_t i = 0; i < columnCount; i++)
+	{
+		const Column &column = dataset->column(i);
 
-	archive_entry_free(entry);
+		//Progress is reported once the column is in the archive, the flush below is what waits for the last ones
+		auto written = [&, i]()
+		{
+			progress = 49 + int(50 * (i + 1) / columnCount);
+			if (progress != lastProgress)
+			{
+				progressCallback("Saving Data Set", progress);
+				lastProgress = progress;
+			}
+		};
 
+		if (column.columnType() != Column::ColumnTypeScale)	addDataChunks<int>(		pipeline, column, uint32_t(i), rowCount, chunks.data() + i * columnChunks, written);
+		else												addDataChunks<double>(	pipeline, column, uint32_t(i), rowCount, chunks.data() + i * columnChunks, written);
+	}
 
-	//Create new entry for archive NOTE: must be done before data is added
-	entry = archive_entry_new();
-	std::string dd = std::string("data.bin");
-	archive_entry_set_pathname(entry, dd.c_str());
-	archive_entry_set_size(entry, int(dataSize));
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); // Not sure what this does
-	archive_write_header(a, entry);
+	pipeline.flush(); //The checksums are only known once the chunks have been produced
 
-	//Data data to archive
+	std::vector<uint32_t> index = { uint32_t(columnCount), uint32_t(rowCount), uint32_t(chunks.size()) };
 
-	for (size_t i = 0; i < columnCount; i++)
-	{
-		Column &column = dataset->column(i);
+	for (const DataChunk & chunk : chunks)
+		index.insert(index.end(), { chunk.column, chunk.firstRow, chunk.rowCount, chunk.typeSize, chunk.checksum });
 
-		if (column.columnType() != Column::ColumnTypeScale)
-			for (const int & value : column.AsInts)
-				archive_write_data(a, reinterpret_cast<const char*>(&value), sizeof(int));
-		else
-			for (const double & value : column.AsDoubles)
-				archive_write_data(a, reinterpret_cast<const char*>(&value), sizeof(double));
+	pipeline.add(dataIndexEntryName, std::string(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(uint32_t)));
 
-		progress = 49 + 50 * int(i / columnCount);
-		if (progress != lastProgress)
+	//The original text of the cells that are treated as missing, per column: the length of the name, the name and the values. The checksum of all that comes last.
+	std::string emptyValues;
+	for (const auto & columnEmptyValues : package->emptyValuesMap())
+		if (!columnEmptyValues.second.empty())
 		{
-			progressCallback("Saving Data Set", progress);
-			lastProgress = progress;
+			uint32_t nameLength = uint32_t(columnEmptyValues.first.size());
+			emptyValues.append(reinterpret_cast<const char*>(&nameLength), sizeof(uint32_t));
+			emptyValues.append(columnEmptyValues.first);
+			columnEmptyValues.second.appendBinary(emptyValues);
 		}
-	}
 
-	archive_entry_free(entry);
-
-	//Create new entry for archive: HTML results
-	std::string html = package->analysesHTML();
-	size_t htmlSize = html.size();
-	entry = archive_entry_new();
-	std::string dd3 = std::string("index.html");
-	archive_entry_set_pathname(entry, dd3.c_str());
-	archive_entry_set_size(entry, int(htmlSize));
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); // Not sure what this does
-	archive_write_header(a, entry);
-
-	size_t ws = archive_write_data(a, html.c_str(), htmlSize);
-	if (ws != size_t(htmlSize))
-		throw std::runtime_error("Can't save jasp archive writing ERROR");
-
-	archive_entry_free(entry);
+	uint32_t emptyValuesChecksum = checksum(emptyValues.data(), emptyValues.size());
+	emptyValues.append(reinterpret_cast<const char*>(&emptyValuesChecksum), sizeof(uint32_t));
 
+	pipeline.add(emptyValuesEntryName,	emptyValues);
+	pipeline.add("index.html",			package->analysesHTML());
 }
 
-void JASPExporter::saveJASPArchive(archive *a, DataSetPackage *package, boost::function<void (const std::string &, int)>)
+void JASPExporter::saveJASPArchive(EntryPipeline &pipeline, DataSetPackage *package, boost::function<void (const std::string &, int)>)
 {
 	if (package->hasAnalyses())
 	{
-		struct archive_entry *entry;
-
 		const Json::Value &analysesJson = package->analysesData();
 
-		//Create new entry for archive NOTE: must be done before data is added
-		std::string analysesString = analysesJson.toStyledString();
-		size_t sizeOfAnalysesString = analysesString.size();
-
-		entry = archive_entry_new();
-		std::string dd4 = std::string("analyses.json");
-		archive_entry_set_pathname(entry, dd4.c_str());
-		archive_entry_set_size(entry, int(sizeOfAnalysesString));
-		archive_entry_set_filetype(entry, AE_IFREG);
-		archive_entry_set_perm(entry, 0644); // Not sure what this does
-		archive_write_header(a, entry);
-
-		archive_write_data(a, analysesString.c_str(), sizeOfAnalysesString);
-
-		archive_entry_free(entry);
-
-		char imagebuff[8192];
+		//NOTE: must be added before the resource files
+		pipeline.add("analyses.json", analysesJson.toStyledString());
 
 		Json::Value analysesDataList = analysesJson;
 		if (!analysesDataList.isArray())
 			analysesDataList = analysesJson["analyses"];
 
+		//The resource files (mostly plots) are read on other threads, those that are compressed already are stored as they are
 		for (Json::Value::iterator iter = analysesDataList.begin(); iter != analysesDataList.end(); iter++)
 		{
 			Json::Value &analysisJson = *iter;
-			std::vector<std::string> paths = TempFiles::retrieveList(analysisJson["id"].asInt());
-			for (size_t j = 0; j < paths.size(); j++)
+
+			for (const std::string & path : TempFiles::retrieveList(analysisJson["id"].asInt()))
 			{
-				FileReader fileInfo = FileReader(TempFiles::sessionDirName() + "/" + paths[j]);
-				if (fileInfo.exists())
+				std::string					filePath = TempFiles::sessionDirName() + "/" + path;
+				boost::system::error_code	error;
+				uintmax_t					fileSize = boost::filesystem::file_size(Utils::osPath(filePath), error);
+
+				pipeline.add([path, filePath]()
 				{
-					int imageSize = fileInfo.size();
+					EntryPipeline::Entries	entries;
+					FileReader				fileInfo(filePath);
+
+					if (fileInfo.exists())
+					{
+						std::string	contents(size_t(fileInfo.size()), '\0');
+						size_t		read		= 0;
+						int			bytes		= 0,
+									errorCode	= 0;
 
-					entry = archive_entry_new();
-					std::string dd4 = paths[j];
-					archive_entry_set_pathname(entry, dd4.c_str());
-					archive_entry_set_size(entry, imageSize);
-					archive_entry_set_filetype(entry, AE_IFREG);
-					archive_entry_set_perm(entry, 0644); // Not sure what this does
-					archive_write_header(a, entry);
+						while (read < contents.size() && (bytes = fileInfo.readData(&contents[read], int(contents.size() - read), errorCode)) > 0 && errorCode == 0)
+							read += size_t(bytes);
 
-					int	bytes		= 0,
-						errorCode	= 0;
+						if (errorCode < 0)
+							throw std::runtime_error("Required resource files could not be accessed.");
 
-					while ((bytes = fileInfo.readData(imagebuff, sizeof(imagebuff), errorCode)) > 0 && errorCode == 0) {
-						archive_write_data(a, imagebuff, size_t(bytes));
+						contents.resize(read);
+						entries.push_back({ path, std::move(contents), isCompressed(path) });
 					}
 
-					archive_entry_free(entry);
+					fileInfo.close();
 
-					if (errorCode < 0)
-						throw std::runtime_error("Required resource files could not be accessed.");
-				}
-				fileInfo.close();
+					return entries;
+				}, error ? 0 : size_t(fileSize));
 			}
 		}
 	}
 }
 
-void JASPExporter::createJARContents(archive *a)
+template<typename T> void JASPExporter::addDataChunks(EntryPipeline &pipeline, const Column &column, uint32_t columnIndex, size_t rowCount, DataChunk * chunks, EntryPipeline::Written written)
 {
-	struct archive_entry *entry = archive_entry_new();
+	pipeline.add([&column, columnIndex, rowCount, chunks]()
+	{
+		EntryPipeline::Entries	entries;
+		DataChunk			*	chunk = chunks;
 
-	std::stringstream manifestStream;
-	manifestStream << "Manifest-Version: 1.0" << "\n";
-	manifestStream << "Created-By: " << AppInfo::getShortDesc() << "\n";
-	manifestStream << "Data-Archive-Version: " << dataArchiveVersion.asString() << "\n";
-	manifestStream << "JASP-Archive-Version: " << jaspArchiveVersion.asString() << "\n";
+		//The values are copied straight into the contents of each chunk, so the column is only held once
+		for (size_t firstRow = 0; firstRow < rowCount; firstRow += dataRowsPerChunk, chunk++)
+		{
+			size_t		rows		= std::min(dataRowsPerChunk, rowCount - firstRow);
+			std::string	contents(rows * sizeof(T), '\0');
+
+			column.copyValues(reinterpret_cast<T*>(&contents[0]), int(rows), nullptr, int(firstRow));
 
-	manifestStream.flush();
+			*chunk = { columnIndex, uint32_t(firstRow), uint32_t(rows), uint32_t(sizeof(T)), checksum(contents.data(), contents.size()) };
+			entries.push_back({ dataChunkEntryName(*chunk), std::move(contents), false });
+		}
 
-	const std::string& tmp	= manifestStream.str();
-	size_t manifestSize		= tmp.size();
-	const char* manifest	= tmp.c_str();
+		return entries;
+	}, rowCount * sizeof(T), written);
+}
 
-	std::string f1 = std::string("META-INF/MANIFEST.MF");
-	archive_entry_set_pathname(entry, f1.c_str());
-	archive_entry_set_size(entry, int(manifestSize));
+void JASPExporter::writeEntry(archive *a, const std::string &name, const char * data, size_t size, bool store)
+{
+	if (store)
+		archive_write_zip_set_compression_store(a);
+
+	struct archive_entry *entry = archive_entry_new();
+
+	archive_entry_set_pathname(entry, name.c_str());
+	archive_entry_set_size(entry, int64_t(size));
 	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); // Not sure what this does
+	archive_entry_set_perm(entry, 0644);
 	archive_write_header(a, entry);
 
-	archive_write_data(a, manifest, manifestSize);
+	if (size > 0 && archive_write_data(a, data, size) != ssize_t(size))
+		throw std::runtime_error("Can't save jasp archive writing ERROR");
 
 	archive_entry_free(entry);
+
+	if (store)
+		archive_write_zip_set_compression_deflate(a);
+}
+
+bool JASPExporter::isCompressed(const std::string &name)
+{
+	static const std::vector<std::string> compressedExtensions = { ".png", ".jpg", ".jpeg", ".gif", ".svgz", ".gz", ".zip", ".jasp" };
+
+	std::string extension = boost::filesystem::path(name).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+	return std::find(compressedExtensions.begin(), compressedExtensions.end(), extension) != compressedExtensions.end();
+}
+
+std::string JASPExporter::dataChunkEntryName(const DataChunk & chunk)
+{
+	return "data/" + std::to_string(chunk.column) + "/" + std::to_string(chunk.firstRow) + ".bin";
+}
+
+bool JASPExporter::parseDataChunkEntryName(const std::string & name, DataChunk & chunk)
+{
+	unsigned int column, firstRow;
+
+	if (sscanf(name.c_str(), "data/%u/%u.bin", &column, &firstRow) != 2)
+		return false;
+
+	chunk.column	= column;
+	chunk.firstRow	= firstRow;
+
+	return dataChunkEntryName(chunk) == name;
+}
+
+uint32_t JASPExporter::checksum(const char * data, size_t size)
+{
+	Checksum crc;
+	crc.process_bytes(data, size);
+
+	return crc.checksum();
+}
+
+std::string JASPExporter::createJARContents()
+{
+	std::stringstream manifestStream;
+	manifestStream << "Manifest-Version: 1.0" << "\n";
+	manifestStream << "Created-By: " << AppInfo::getShortDesc() << "\n";
+	manifestStream << "Data-Archive-Version: " << dataArchiveVersion.asString() << "\n";
+	manifestStream << "JASP-Archive-Version: " << jaspArchiveVersion.asString() << "\n";
+
+	return manifestStream.str();
 }
 
 
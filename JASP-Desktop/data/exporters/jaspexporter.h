@@ -21,6 +21,9 @@
 #include "exporter.h"
 
 #include "libzip/archive.h"
+#include <boost/crc.hpp>
+#include <cstdint>
+#include <functional>
 
 class JASPExporter: public Exporter
 {
@@ -28,14 +31,39 @@ public:
 	static const Version jaspArchiveVersion;
 	static const Version dataArchiveVersion;
 
+	///The data of a column is stored in chunks of at most dataRowsPerChunk rows, each in their own archive entry and listed in the index "data.index".
+	struct DataChunk
+	{
+		uint32_t	column,
+					firstRow,
+					rowCount,
+					typeSize,
+					checksum; ///< crc32 of the uncompressed chunk
+	};
+
+	static const size_t			dataRowsPerChunk;
+	static const std::string	dataIndexEntryName;
+	static const std::string	emptyValuesEntryName; ///< Binary ColumnEmptyValues per column, replaces the "emptyValuesMap" in metadata.json since data archive 2.1.0
+
+	typedef boost::crc_32_type	Checksum; ///< For checksums that are computed piece by piece, like while reading a chunk
+
+	static std::string			dataChunkEntryName(const DataChunk & chunk);
+	static bool					parseDataChunkEntryName(const std::string & name, DataChunk & chunk); ///< Fills in column and firstRow of chunk
+	static uint32_t				checksum(const char * data, size_t size);
+
 	JASPExporter();
 	void saveDataSet(const std::string &path, DataSetPackage* package, boost::function<void (const std::string &, int)> progressCallback) OVERRIDE;
 
 private:
-	static void saveDataArchive(archive *a, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback);
-	static void saveJASPArchive(archive *a, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback);
+	class EntryPipeline;
+
+	static void saveDataArchive(EntryPipeline &pipeline, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback);
+	static void saveJASPArchive(EntryPipeline &pipeline, DataSetPackage *package, boost::function<void (const std::string &, int)> progressCallback);
 
-	static void createJARContents(archive *a);
+	static std::string createJARContents();
+	static void writeEntry(archive *a, const std::string &name, const char * data, size_t size, bool store = false);
+	static bool isCompressed(const std::string &name);
+	template<typename T> static void addDataChunks(EntryPipeline &pipeline, const Column &column, uint32_t columnIndex, size_t rowCount, DataChunk * chunks, std::function<void()> written);
 	static std::string getColumnTypeName(Column::ColumnType columnType);
 };
 
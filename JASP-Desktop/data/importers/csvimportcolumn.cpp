@@ -25,6 +25,11 @@ const vector<string> &CSVImportColumn::getValues() const
 	return _data;
 }
 
+size_t CSVImportColumn::labelCountEstimate() const
+{
+	return _estimateLabelCount(_data);
+}
+
 bool CSVImportColumn::isValueEqual(Column &col, size_t row) const
 {
 	if (row >= _data.size())
@@ -11,6 +11,7 @@ public:
 
 	virtual size_t size() const;
 	virtual bool isValueEqual(Column &col, size_t row) const;
+	virtual size_t labelCountEstimate() const;
 
 	void addValue(const std::string &value);
 	const std::vector<std::string>& getValues() const;
@@ -1,5 +1,6 @@
 #include "importcolumn.h"
 #include <cmath>
+#include <algorithm>
 #include "utils.h"
 
 using namespace std;
@@ -39,6 +40,35 @@ string ImportColumn::getName() const
 	return _name;
 }
 
+size_t ImportColumn::_estimateLabelCount(const vector<string> &values)
+{
+	// Looks at an evenly spread sample: numbers probably end up as a scale without labels, otherwise the distinct values in the sample are extrapolated when they keep on coming
+	const size_t	sampleSize	= 1024;
+	size_t			step		= std::max(size_t(1), values.size() / sampleSize),
+					sampled		= 0;
+	bool			allNumbers	= true;
+	std::set<string> distinct;
+
+	for (size_t row = 0; row < values.size(); row += step, sampled++)
+	{
+		const string &value = values[row];
+		double doubleValue;
+
+		if (allNumbers && !convertValueToDouble(value, doubleValue))
+			allNumbers = false;
+
+		distinct.insert(value);
+	}
+
+	if (sampled == 0 || (allNumbers && distinct.size() > sampled / 2))
+		return 0;
+
+	if (distinct.size() <= sampled / 2)
+		return distinct.size();
+
+	return distinct.size() * values.size() / sampled;
+}
+
 string ImportColumn::_deEuropeanise(const string &value)
 {
 	int dots = 0;
@@ -122,9 +152,9 @@ bool ImportColumn::convertValueToDouble(const string &strValue, double &doubleVa
 	return success;
 }
 
-bool ImportColumn::convertToInt(const vector<string> &values, vector<int> &intValues, set<int> &uniqueValues, map<int, string> &emptyValuesMap)
+bool ImportColumn::convertToInt(const vector<string> &values, vector<int> &intValues, set<int> &uniqueValues, ColumnEmptyValues &emptyValues)
 {
-	emptyValuesMap.clear();
+	emptyValues.clear();
 	uniqueValues.clear();
 	intValues.clear();
 	intValues.reserve(values.size());
@@ -138,7 +168,7 @@ bool ImportColumn::convertToInt(const vector<string> &values, vector<int> &intVa
 		if (convertValueToInt(value, intValue))
 		{
 			if (intValue != INT_MIN)	uniqueValues.insert(intValue);
-			else if (!value.empty())	emptyValuesMap.insert(make_pair(row, value));
+			else if (!value.empty())	emptyValues.set(row, value);
 
 			intValues.push_back(intValue);
 		}
@@ -151,9 +181,9 @@ bool ImportColumn::convertToInt(const vector<string> &values, vector<int> &intVa
 	return true;
 }
 
-bool ImportColumn::convertToDouble(const vector<string> &values, vector<double> &doubleValues, map<int, string> &emptyValuesMap)
+bool ImportColumn::convertToDouble(const vector<string> &values, vector<double> &doubleValues, ColumnEmptyValues &emptyValues)
 {
-	emptyValuesMap.clear();
+	emptyValues.clear();
 	doubleValues.clear();
 	doubleValues.reserve(values.size());
 
@@ -167,7 +197,7 @@ bool ImportColumn::convertToDouble(const vector<string> &values, vector<double>
 			doubleValues.push_back(doubleValue);
 
 			if (std::isnan(doubleValue) && value != Utils::emptyValue)
-				emptyValuesMap.insert(make_pair(row, value));
+				emptyValues.set(row, value);
 		}
 		else
 			return false;
@@ -18,9 +18,10 @@ public:
 
 
 	virtual std::string getName() const;
+	virtual size_t labelCountEstimate() const { return 0; } ///< How many labels this column is expected to need once imported, used to reserve shared memory up front.
 
-	static bool convertToInt(const std::vector<std::string> &values, std::vector<int> &intValues, std::set<int> &uniqueValues, std::map<int, std::string> &emptyValuesMap);
-	static bool convertToDouble(const std::vector<std::string> &values, std::vector<double> &doubleValues, std::map<int, std::string> &emptyValuesMap);
+	static bool convertToInt(const std::vector<std::string> &values, std::vector<int> &intValues, std::set<int> &uniqueValues, ColumnEmptyValues &emptyValues);
+	static bool convertToDouble(const std::vector<std::string> &values, std::vector<double> &doubleValues, ColumnEmptyValues &emptyValues);
 
 	static bool convertValueToInt(const std::string &strValue, int &intValue);
 	static bool convertValueToDouble(const std::string &strValue, double &doubleValue);
@@ -32,6 +33,7 @@ protected:
 	std::string _name;
 
 	static std::string _deEuropeanise(const std::string &value);
+	static size_t _estimateLabelCount(const std::vector<std::string> &values);
 
 };
 
@@ -25,9 +25,13 @@ void Importer::loadDataSet(const std::string &locator, boost::function<void(cons
 
 	if (columnCount == 0)
 		return;
-	int rowCount = importDataSet->rowCount();
+	int		rowCount	= importDataSet->rowCount();
+	size_t	labelCount	= 0;
 
-	setDataSetSize(columnCount, rowCount);
+	for (ImportColumn *importColumn : *importDataSet)
+		labelCount += importColumn->labelCountEstimate();
+
+	setDataSetSize(columnCount, rowCount, labelCount);
 
 	int colNo = 0;
 	for (ImportColumn *importColumn : *importDataSet)
@@ -137,29 +141,30 @@ void Importer::fillSharedMemoryColumnWithStrings(const std::vector<std::string>
 	std::set<int>				uniqueValues;
 	std::vector<int>			intValues;
 	std::vector<double>			doubleValues;
-	std::map<int, std::string>	emptyValuesMap;
+	ColumnEmptyValues			emptyValues;
 
 	//If less unique integers than the thresholdScale then we think it must be ordinal: https://github.com/jasp-stats/INTERNAL-jasp/issues/270
 	bool	useCustomThreshold	= Settings::value(Settings::USE_CUSTOM_THRESHOLD_SCALE).toBool();
 	size_t	thresholdScale		= (useCustomThreshold ? Settings::value(Settings::THRESHOLD_SCALE) : Settings::defaultValue(Settings::THRESHOLD_SCALE)).toUInt();
 
-	bool valuesAreIntegers = ImportColumn::convertToInt(values, intValues, uniqueValues, emptyValuesMap);
+	bool valuesAreIntegers = ImportColumn::convertToInt(values, intValues, uniqueValues, emptyValues);
 
 	auto isNominalInt = [&](){ return valuesAreIntegers && uniqueValues.size() == 2; };
 	auto isOrdinal = [&](){ return valuesAreIntegers && uniqueValues.size() > 2 && uniqueValues.size() <= thresholdScale; };
-	auto isScalar  = [&]() { return ImportColumn::convertToDouble(values, doubleValues, emptyValuesMap); };
+	auto isScalar  = [&]() { return ImportColumn::convertToDouble(values, doubleValues, emptyValues); };
 
 	if		(isOrdinal())					column.setColumnAsNominalOrOrdinal(intValues, uniqueValues, true);
 	else if	(isNominalInt())				column.setColumnAsNominalOrOrdinal(intValues, uniqueValues, false);
 	else if	(isScalar())					column.setColumnAsScale(doubleValues);
-	else				emptyValuesMap =	column.setColumnAsNominalText(values);
+	else				emptyValues =		column.setColumnAsNominalText(values);
 
-	_packageData->storeInEmptyValues(column.name(), emptyValuesMap);
+	_packageData->storeInEmptyValues(column.name(), std::move(emptyValues));
 }
 
-DataSet* Importer::setDataSetSize(int columnCount, int rowCount)
+DataSet* Importer::setDataSetSize(int columnCount, int rowCount, size_t labelCount)
 {
-	DataSet *dataSet	= _packageData->dataSet();
+	// Growing the shared memory once now is a lot cheaper than letting the columns run out of it one by one
+	DataSet *dataSet	= SharedMemory::reserveDataSet(_packageData->dataSet(), DataSet::estimateSharedMemorySize(columnCount, std::max(rowCount, 0), labelCount));
 	bool success		= true;
 	do
 	{
@@ -26,7 +26,7 @@ protected:
 	DataSetPackage *_packageData;
 
 private:
-	DataSet* setDataSetSize(int columnCount, int rowCount);
+	DataSet* setDataSetSize(int columnCount, int rowCount, size_t labelCount = 0);
 	DataSet* setDataSetRowCount(int rowCount)				{ return setDataSetSize(_packageData->dataSet()->columnCount(), rowCount); }
 	DataSet* increaseDataSetColCount(int rowCount)			{ return setDataSetSize(_packageData->dataSet()->columnCount() + 1, rowCount); }
 
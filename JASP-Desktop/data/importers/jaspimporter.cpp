@@ -37,6 +37,10 @@
 
 #include "resultstesting/compareresults.h"
 #include "log.h"
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <cstring>
 
 void JASPImporter::loadDataSet(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback)
 {	
@@ -59,15 +63,230 @@ void JASPImporter::loadDataArchive(DataSetPackage *packageData, const std::strin
 {
 	if (packageData->dataArchiveVersion().major == 1)
 		loadDataArchive_1_00(packageData, path, progressCallback);
+	else if (packageData->dataArchiveVersion().major == 2)
+		loadDataArchive_2_00(packageData, path, progressCallback);
 	else
 		throw std::runtime_error("The file version is not supported.\nPlease update to the latest version of JASP to view this file.");
 }
 
-void JASPImporter::loadDataArchive_1_00(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback)
+///Maps the nominal-text keys stored in old JASP files to label values, through a dense table when the keys are not spread out too much.
+class NominalTextKeyRemapper
+{
+public:
+	NominalTextKeyRemapper(const std::map<int, int> & mapValues) : _mapValues(mapValues)
+	{
+		if(mapValues.size() == 0)
+			return;
+
+		_minKey			= mapValues.begin()->first;
+		long long range	= (long long)(mapValues.rbegin()->first) - _minKey + 1;
+
+		if(range <= 4 * (long long)(mapValues.size()) + 1024)
+		{
+			_dense.resize(range, 0);
+			for(const auto & keyValue : mapValues)
+				_dense[keyValue.first - _minKey] = keyValue.second;
+		}
+	}
+
+	int operator()(int key) const
+	{
+		if(_dense.size() > 0)
+		{
+			long long index = (long long)(key) - _minKey;
+			return index >= 0 && index < (long long)(_dense.size()) ? _dense[index] : 0;
+		}
+
+		auto found = _mapValues.find(key);
+		return found == _mapValues.end() ? 0 : found->second; //Unknown keys used to become 0 as well
+	}
+
+private:
+	const std::map<int, int>	_mapValues;
+	std::vector<int>			_dense;
+	int							_minKey = 0;
+};
+
+///Reads exactly size bytes, the archive might hand them over in smaller pieces.
+static void readDataEntryBlock(FileReader & dataEntry, char * data, size_t size)
+{
+	const size_t maxChunk = 1 << 24;
+
+	while(size > 0)
+	{
+		int errorCode	= 0,
+			toRead		= int(size > maxChunk ? maxChunk : size),
+			read		= dataEntry.readData(data, toRead, errorCode);
+
+		if (errorCode != 0 || read <= 0)
+			throw std::runtime_error("Could not read '" + dataEntry.fileName() + "' in JASP archive.");
+
+		data += read;
+		size -= read;
+	}
+}
+
+///Reads the current entry of archive a completely and computes its checksum while at it.
+static std::shared_ptr<std::vector<char>> readArchiveEntry(archive * a, archive_entry * entry, uint32_t & checksum)
+{
+	bool					sizeKnown	= archive_entry_size_is_set(entry);
+	auto					data		= std::make_shared<std::vector<char>>(sizeKnown ? size_t(archive_entry_size(entry)) : 1 << 16);
+	size_t					read		= 0;
+	JASPExporter::Checksum	crc;
+
+	while (!sizeKnown || read < data->size())
+	{
+		if (read == data->size())
+			data->resize(data->size() * 2);
+
+		ssize_t bytes = archive_read_data(a, data->data() + read, data->size() - read);
+
+		if (bytes < 0 || (bytes == 0 && sizeKnown))
+			throw std::runtime_error("Could not read '" + std::string(archive_entry_pathname(entry)) + "' in JASP archive.");
+
+		if (bytes == 0)
+			break;
+
+		crc.process_bytes(data->data() + read, size_t(bytes));
+		read += size_t(bytes);
+	}
+
+	data->resize(read);
+	checksum = crc.checksum();
+
+	return data;
+}
+
+///Remaps (when needed) and writes values read from the archive into the column on another thread.
+static std::future<void> writeColumnValuesAsync(Column & column, int firstRow, int rowCount, std::shared_ptr<std::vector<char>> buffer, std::shared_ptr<NominalTextKeyRemapper> remapper)
+{
+	return std::async(std::launch::async, [&column, firstRow, rowCount, buffer, remapper]()
+	{
+		if (column.columnType() == Column::ColumnTypeScale)
+		{
+			column.setValues(firstRow, reinterpret_cast<const double*>(buffer->data()), rowCount);
+			return;
+		}
+
+		int * values = reinterpret_cast<int*>(buffer->data());
+
+		if (remapper)
+			for (int r = 0; r < rowCount; r++)
+				if (values[r] != INT_MIN)
+					values[r] = (*remapper)(values[r]);
+
+		column.setValues(firstRow, values, rowCount);
+	});
+}
+
+void JASPImporter::readEmptyValues(DataSetPackage *packageData, const std::string &path)
+{
+	FileReader emptyValuesEntry(path, JASPExporter::emptyValuesEntryName);
+	if (!emptyValuesEntry.exists())
+		return;
+
+	std::vector<char> data(size_t(emptyValuesEntry.size()));
+	readDataEntryBlock(emptyValuesEntry, data.data(), data.size());
+	emptyValuesEntry.close();
+
+	const std::runtime_error corrupted("The missing values of the data in JASP archive have been corrupted.");
+
+	if (data.size() < sizeof(uint32_t))
+		throw corrupted;
+
+	size_t		size = data.size() - sizeof(uint32_t);
+	uint32_t	storedChecksum;
+
+	memcpy(&storedChecksum, data.data() + size, sizeof(uint32_t));
+	if (JASPExporter::checksum(data.data(), size) != storedChecksum)
+		throw corrupted;
+
+	for (size_t pos = 0; pos < size;)
+	{
+		uint32_t nameLength;
+
+		if (size - pos < sizeof(uint32_t))
+			throw corrupted;
+
+		memcpy(&nameLength, data.data() + pos, sizeof(uint32_t));
+		pos += sizeof(uint32_t);
+
+		if (size - pos < nameLength)
+			throw corrupted;
+
+		std::string			colName(data.data() + pos, nameLength);
+		ColumnEmptyValues	emptyValues;
+
+		pos += nameLength;
+		pos += emptyValues.readBinary(data.data() + pos, size - pos);
+
+		packageData->storeInEmptyValues(colName, std::move(emptyValues));
+	}
+}
+
+archive * JASPImporter::openArchive(const std::string &path)
+{
+#ifdef _WIN32
+	boost::filesystem::path pathArchive = boost::nowide::widen(path);
+#else
+	boost::filesystem::path pathArchive = path;
+#endif
+
+	archive * a = archive_read_new();
+	archive_read_support_filter_all(a);
+	archive_read_support_format_all(a);
+
+#ifdef _WIN32
+	int r = archive_read_open_filename_w(a, pathArchive.native().c_str(), 10240);
+#else
+	int r = archive_read_open_filename(a, pathArchive.native().c_str(), 10240);
+#endif
+
+	if (r != ARCHIVE_OK)
+	{
+		archive_read_free(a);
+		throw std::runtime_error("The selected JASP archive '" + path + "' could not be opened.");
+	}
+
+	return a;
+}
+
+std::vector<JASPExporter::DataChunk> JASPImporter::parseDataIndex(const std::vector<char> &data, size_t columnCount, size_t rowCount)
+{
+	const size_t			headerSize	= 3,
+							chunkSize	= 5;
+	std::vector<uint32_t>	index(data.size() / sizeof(uint32_t));
+
+	memcpy(index.data(), data.data(), index.size() * sizeof(uint32_t));
+
+	if (index.size() < headerSize || index[0] != columnCount || index[1] != rowCount || index.size() != headerSize + chunkSize * index[2])
+		throw std::runtime_error("The index of the data in JASP archive has been corrupted.");
+
+	std::vector<JASPExporter::DataChunk>	chunks;
+	std::vector<size_t>						rowsPerColumn(columnCount, 0);
+
+	for (size_t i = headerSize; i < index.size(); i += chunkSize)
+	{
+		JASPExporter::DataChunk chunk = { index[i], index[i + 1], index[i + 2], index[i + 3], index[i + 4] };
+
+		if (chunk.column >= columnCount || size_t(chunk.firstRow) + chunk.rowCount > rowCount)
+			throw std::runtime_error("The index of the data in JASP archive has been corrupted.");
+
+		rowsPerColumn[chunk.column] += chunk.rowCount;
+		chunks.push_back(chunk);
+	}
+
+	for (size_t rows : rowsPerColumn)
+		if (rows != rowCount)
+			throw std::runtime_error("The index of the data in JASP archive is incomplete.");
+
+	return chunks;
+}
+
+void JASPImporter::loadDataArchiveMetaData(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback, Json::Value &metaData, std::map<std::string, std::map<int, int> > &mapNominalTextValues)
 {
 	bool success = false;
 
-	Json::Value metaData;
 	Json::Value xData;
 
 	int columnCount = 0;
@@ -124,15 +343,27 @@ void JASPImporter::loadDataArchive_1_00(DataSetPackage *packageData, const std::
 				std::string value		= valueJson.asString();
 				map[row]				= value;
 			}
-			packageData->storeInEmptyValues(colName, map);
+			packageData->storeInEmptyValues(colName, ColumnEmptyValues(map));
 		}
 	}
+	else
+		readEmptyValues(packageData, path);
 
 	columnCount = dataSetDesc["columnCount"].asInt();
 	rowCount	= dataSetDesc["rowCount"].asInt();
 	if (rowCount < 0 || columnCount < 0)
 		throw std::runtime_error("Data size has been corrupted.");
 
+	// The labels are either in the fields themselves or in xdata.json, counting them first means the shared memory only needs to grow once
+	const Json::Value	&	labelsData	= xData;
+	size_t					labelCount	= 0;
+
+	for (const Json::Value &columnDesc : dataSetDesc["fields"])
+		if (!columnDesc["labels"].isNull())	labelCount += columnDesc["labels"].size();
+		else if (!labelsData.isNull())		labelCount += labelsData[columnDesc["name"].asString()]["labels"].size();
+
+	packageData->setDataSet(SharedMemory::reserveDataSet(packageData->dataSet(), DataSet::estimateSharedMemorySize(columnCount, rowCount, labelCount)));
+
 	do
 	{
 		try
@@ -163,7 +394,6 @@ void JASPImporter::loadDataArchive_1_00(DataSetPackage *packageData, const std::
 
 	Json::Value &columnsDesc = dataSetDesc["fields"];
 	int i = 0;
-	std::map<std::string, std::map<int, int> > mapNominalTextValues;
 
 	for (Json::Value columnDesc : columnsDesc)
 	{
@@ -248,49 +478,166 @@ void JASPImporter::loadDataArchive_1_00(DataSetPackage *packageData, const std::
 
 		i += 1;
 	}
+}
+
+void JASPImporter::loadDataArchive_1_00(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback)
+{
+	Json::Value									metaData;
+	std::map<std::string, std::map<int, int> >	mapNominalTextValues;
+
+	loadDataArchiveMetaData(packageData, path, progressCallback, metaData, mapNominalTextValues);
+
+	int					columnCount		= int(packageData->dataSet()->columnCount()),
+						rowCount		= int(packageData->dataSet()->rowCount());
+	unsigned long long	progress,
+						lastProgress	= -1;
 
 	std::string entryName = "data.bin";
 	FileReader dataEntry = FileReader(path, entryName);
 	if (!dataEntry.exists())
 		throw std::runtime_error("Entry " + entryName + " could not be found.");
 
-	char buff[sizeof(double) > sizeof(int) ? sizeof(double) : sizeof(int)];
+	//data.bin holds the columns one after the other, so each column is read as a whole and then remapped and written into the dataset on another thread while the next one gets decompressed.
+	std::future<void> writingColumn;
 
 	for (int c = 0; c < columnCount; c++)
 	{
 		Column &column					= packageData->dataSet()->column(c);
 		Column::ColumnType columnType	= column.columnType();
-		int typeSize					= (columnType == Column::ColumnTypeScale) ? sizeof(double) : sizeof(int);
-		std::map<int, int>& mapValues	= mapNominalTextValues[column.name()];
+		bool isScale					= columnType == Column::ColumnTypeScale;
+		size_t typeSize					= isScale ? sizeof(double) : sizeof(int);
+		auto buffer						= std::make_shared<std::vector<char>>(typeSize * rowCount);
+
+		readDataEntryBlock(dataEntry, buffer->data(), buffer->size());
+
+		if(writingColumn.valid())
+			writingColumn.get(); //Rethrows anything that went wrong while writing the previous column
+
+		writingColumn = writeColumnValuesAsync(column, 0, rowCount, buffer, columnType == Column::ColumnTypeNominalText ? std::make_shared<NominalTextKeyRemapper>(mapNominalTextValues[column.name()]) : nullptr);
 
-		for (int r = 0; r < rowCount; r++)
+		progress = 50 + (50 * (c + 1) / columnCount);
+		if (progress != lastProgress)
 		{
-			int errorCode	= 0;
-			int size		= dataEntry.readData(buff, typeSize, errorCode);
+			progressCallback("Loading Data Set", progress);
+			lastProgress = progress;
+		}
+	}
+
+	if(writingColumn.valid())
+		writingColumn.get();
 
-			if (errorCode != 0 || size != typeSize)
-				throw std::runtime_error("Could not read 'data.bin' in JASP archive.");
+	dataEntry.close();
 
-			if (columnType == Column::ColumnTypeScale)
-				column.setValue(r, *(double*)buff);
-			else
+	loadDataArchiveRest(packageData, path, metaData);
+}
+
+void JASPImporter::loadDataArchive_2_00(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback)
+{
+	Json::Value									metaData;
+	std::map<std::string, std::map<int, int> >	mapNominalTextValues;
+
+	loadDataArchiveMetaData(packageData, path, progressCallback, metaData, mapNominalTextValues);
+
+	DataSet										*	dataSet		= packageData->dataSet();
+	std::vector<std::shared_ptr<NominalTextKeyRemapper>>	remappers(dataSet->columnCount());
+
+	for (size_t c = 0; c < dataSet->columnCount(); c++)
+		if (dataSet->column(c).columnType() == Column::ColumnTypeNominalText)
+			remappers[c] = std::make_shared<NominalTextKeyRemapper>(mapNominalTextValues[dataSet->column(c).name()]);
+
+	//The chunks are read and checksummed in a single pass through the archive, each chunk is named after its column and first row.
+	//The index comes after them, so the chunks that were read are only checked against it at the end. Anything else is skipped over without decompressing it.
+	archive								*	a				= openArchive(path);
+	archive_entry						*	entry;
+	std::map<std::string, JASPExporter::DataChunk>	chunksRead;
+	std::shared_ptr<std::vector<char>>		index;
+	size_t									valuesRead		= 0,
+											valuesTotal		= dataSet->columnCount() * dataSet->rowCount();
+	int										progress,
+											lastProgress	= -1;
+	std::future<void>						writingChunk;
+
+	try
+	{
+		while (archive_read_next_header(a, &entry) == ARCHIVE_OK)
+		{
+			std::string				name	= archive_entry_pathname(entry);
+			JASPExporter::DataChunk	chunk;
+			uint32_t				checksum;
+
+			if (name == JASPExporter::dataIndexEntryName)
 			{
-				int value = *(int*)buff;
-				if (columnType == Column::ColumnTypeNominalText && value != INT_MIN)
-					value = mapValues[value];
-				column.setValue(r, value);
+				index = readArchiveEntry(a, entry, checksum);
+				continue;
 			}
 
-			progress = 50 + (50 * ((c * rowCount) + (r + 1)) / (columnCount * rowCount));
+			if (!JASPExporter::parseDataChunkEntryName(name, chunk))
+				continue;
+
+			if (chunk.column >= dataSet->columnCount())
+				throw std::runtime_error("Data in JASP archive has been corrupted.");
+
+			Column	&	column	= dataSet->column(chunk.column);
+			auto		buffer	= readArchiveEntry(a, entry, checksum);
+
+			chunk.typeSize	= column.columnType() == Column::ColumnTypeScale ? sizeof(double) : sizeof(int);
+			chunk.rowCount	= uint32_t(buffer->size() / chunk.typeSize);
+			chunk.checksum	= checksum;
+
+			if (buffer->size() % chunk.typeSize != 0 || size_t(chunk.firstRow) + chunk.rowCount > dataSet->rowCount())
+				throw std::runtime_error("Data of column '" + column.name() + "' in JASP archive has been corrupted.");
+
+			chunksRead[name] = chunk;
+
+			if (writingChunk.valid())
+				writingChunk.get();
+
+			writingChunk = writeColumnValuesAsync(column, chunk.firstRow, chunk.rowCount, buffer, remappers[chunk.column]);
+
+			valuesRead	+= chunk.rowCount;
+			progress	= 50 + int(50 * valuesRead / std::max(valuesTotal, size_t(1)));
 			if (progress != lastProgress)
 			{
 				progressCallback("Loading Data Set", progress);
 				lastProgress = progress;
 			}
 		}
+
+		if (writingChunk.valid())
+			writingChunk.get();
 	}
-	dataEntry.close();
+	catch (...)
+	{
+		archive_read_free(a);
+		throw;
+	}
+
+	archive_read_free(a);
+
+	if (!index)
+		throw std::runtime_error("Entry " + JASPExporter::dataIndexEntryName + " could not be found.");
+
+	std::vector<JASPExporter::DataChunk> chunks = parseDataIndex(*index, dataSet->columnCount(), dataSet->rowCount());
+
+	if (chunksRead.size() != chunks.size())
+		throw std::runtime_error(chunksRead.size() < chunks.size() ? "Data in JASP archive is incomplete." : "Data in JASP archive has been corrupted.");
+
+	for (const JASPExporter::DataChunk & chunk : chunks)
+	{
+		auto read = chunksRead.find(JASPExporter::dataChunkEntryName(chunk));
 
+		if (read == chunksRead.end())
+			throw std::runtime_error("Data in JASP archive is incomplete.");
+
+		if (read->second.rowCount != chunk.rowCount || read->second.typeSize != chunk.typeSize || read->second.checksum != chunk.checksum)
+			throw std::runtime_error("Data of column '" + dataSet->column(chunk.column).name() + "' in JASP archive has been corrupted.");
+	}
+
+	loadDataArchiveRest(packageData, path, metaData);
+}
+
+void JASPImporter::loadDataArchiveRest(DataSetPackage *packageData, const std::string &path, const Json::Value &metaData)
+{
 	if(resultXmlCompare::compareResults::theOne()->testMode())
 	{
 		//Read the results from when the JASP file was saved and store them in compareResults field
@@ -367,6 +714,9 @@ void JASPImporter::loadJASPArchive_1_00(DataSetPackage *packageData, const std::
 		}
 	}
 	
+	if(resultXmlCompare::compareResults::theOne()->testMode())
+		resultXmlCompare::compareResults::theOne()->setOriginalAnalyses(analysesData);
+
 	packageData->setAnalysesData(analysesData);
 
 }
@@ -20,6 +20,7 @@
 
 
 #include "../datasetpackage.h"
+#include "../exporters/jaspexporter.h"
 
 #include <boost/function.hpp>
 
@@ -37,11 +38,17 @@ private:
 	static void loadDataArchive(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback);
 	static void loadJASPArchive(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback);
 	static void loadDataArchive_1_00(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback);
+	static void loadDataArchive_2_00(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback);
+	static void loadDataArchiveMetaData(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback, Json::Value &metaData, std::map<std::string, std::map<int, int> > &mapNominalTextValues);
+	static void loadDataArchiveRest(DataSetPackage *packageData, const std::string &path, const Json::Value &metaData);
 	static void loadJASPArchive_1_00(DataSetPackage *packageData, const std::string &path, boost::function<void (const std::string &, int)> progressCallback);
 
 	static Column::ColumnType parseColumnType(std::string name);
 	static bool parseJsonEntry(Json::Value &root, const std::string &path, const std::string &entry, bool required);
 	static void readManifest(DataSetPackage *packageData, const std::string &path);
+	static archive * openArchive(const std::string &path);
+	static std::vector<JASPExporter::DataChunk> parseDataIndex(const std::vector<char> &data, size_t columnCount, size_t rowCount);
+	static void readEmptyValues(DataSetPackage *packageData, const std::string &path);
 	static Compatibility isCompatible(DataSetPackage *packageData);
 };
 
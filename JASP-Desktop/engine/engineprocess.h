@@ -0,0 +1,41 @@
+#ifndef ENGINEPROCESS_H
+#define ENGINEPROCESS_H
+
+#include <QObject>
+#include <QProcess>
+
+///A running jaspEngine, either started from its executable or forked from the zygote (see EngineZygote).
+class EngineProcess : public QObject
+{
+	Q_OBJECT
+
+public:
+	EngineProcess(QObject * parent = nullptr) : QObject(parent) {}
+
+	virtual void terminate()	= 0;
+	virtual void kill()			= 0;
+
+signals:
+	void finished(int exitCode, QProcess::ExitStatus exitStatus);
+};
+
+///A jaspEngine started from its executable, which also takes ownership of the QProcess.
+class EngineExecutableProcess : public EngineProcess
+{
+	Q_OBJECT
+
+public:
+	EngineExecutableProcess(QProcess * process, QObject * parent = nullptr) : EngineProcess(parent), _process(process)
+	{
+		_process->setParent(this);
+		connect(_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &EngineProcess::finished);
+	}
+
+	void terminate()	override { _process->terminate();	}
+	void kill()			override { _process->kill();		}
+
+private:
+	QProcess * _process;
+};
+
+#endif // ENGINEPROCESS_H
@@ -2,8 +2,9 @@
 #include "utilities/settings.h"
 #include "gui/messageforwarder.h"
 #include "log.h"
+#include "tracer.h"
 
-EngineRepresentation::EngineRepresentation(IPCChannel * channel, QProcess * slaveProcess, QObject * parent)
+EngineRepresentation::EngineRepresentation(IPCChannel * channel, EngineProcess * slaveProcess, QObject * parent)
 	: QObject(parent), _channel(channel)
 {
 	_imageBackground = Settings::value(Settings::IMAGE_BACKGROUND).toString();
@@ -11,11 +12,11 @@ EngineRepresentation::EngineRepresentation(IPCChannel * channel, QProcess * slav
 }
 
 
-void EngineRepresentation::setSlaveProcess(QProcess * slaveProcess)
+void EngineRepresentation::setSlaveProcess(EngineProcess * slaveProcess)
 {
 	_slaveProcess = slaveProcess;
 	_slaveProcess->setParent(this);
-	connect(_slaveProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),	this,	&EngineRepresentation::jaspEngineProcessFinished);
+	connect(_slaveProcess, &EngineProcess::finished,	this,	&EngineRepresentation::jaspEngineProcessFinished);
 }
 
 EngineRepresentation::~EngineRepresentation()
@@ -46,11 +47,13 @@ void EngineRepresentation::jaspEngineProcessFinished(int exitCode, QProcess::Exi
 	Log::log() << "jaspEngine for channel " << engineChannelID() << " finished!" << std::endl;
 
 	_slaveProcess = nullptr;
+	emit slaveProcessGone(channelNumber());
 }
 
 void EngineRepresentation::clearAnalysisInProgress()
 {
 	_analysisInProgress = nullptr;
+	_plotInProgress		= "";
 	_engineState		= engineState::idle;
 }
 
@@ -234,6 +237,19 @@ void EngineRepresentation::runAnalysisOnProcess(Analysis *analysis)
 
 }
 
+void EngineRepresentation::rewritePlotOnProcess(Analysis *analysis, const std::string & plotName)
+{
+#ifdef PRINT_ENGINE_MESSAGES
+	Log::log() << "send request to rewrite plot '" << plotName << "' of analysis-id #" << analysis->id() << " to jaspEngine on channel #" << channelNumber() << std::endl;
+#endif
+
+	setAnalysisInProgress(analysis);
+	_plotInProgress			= plotName;
+	_plotRewriteRevision	= analysis->revision();
+
+	_channel->send(analysis->createPlotRewriteRequestJson(plotName, _ppi, _imageBackground.toStdString()).toStyledString());
+}
+
 Analysis::Status EngineRepresentation::analysisResultStatusToAnalysStatus(analysisResultStatus result, Analysis * analysis)
 {
 	switch(result)
@@ -255,12 +271,20 @@ void EngineRepresentation::analysisRemoved(Analysis * analysis)
 	if(_engineState != engineState::analysis || _analysisInProgress != analysis)
 		return;
 
+	if(rewritingPlot())
+	{
+		_analysisInProgress = nullptr; //The engine is still busy with the plot, its reply will be dropped
+		return;
+	}
+
 	runAnalysisOnProcess(analysis); //should abort
 	clearAnalysisInProgress();
 }
 
 void EngineRepresentation::processAnalysisReply(Json::Value & json)
 {
+	JASPTRACE_SCOPE(EngineRepresentation::processAnalysisReply);
+
 	if(_engineState == engineState::paused || _engineState == engineState::resuming || _engineState == engineState::idle)
 		return;
 
@@ -279,6 +303,16 @@ void EngineRepresentation::processAnalysisReply(Json::Value & json)
 	analysisResultStatus status	= analysisResultStatusFromString(json.get("status", "error").asString());
 	Analysis *analysis			= _analysisInProgress;
 
+	if(rewritingPlot())
+	{
+		//The analysis might have been changed or removed while its plot was being rewritten, then there is nothing to show anymore
+		if(analysis != nullptr && analysis->isFinished() && analysis->revision() == _plotRewriteRevision && status == analysisResultStatus::imagesRewritten)
+			analysis->imageRewritten(_plotInProgress);
+
+		clearAnalysisInProgress();
+		return;
+	}
+
 	if (analysis->id() != id || analysis->revision() < revision)
 		throw std::runtime_error("Received results for wrong analysis!");
 
@@ -338,7 +372,7 @@ void EngineRepresentation::processAnalysisReply(Json::Value & json)
 
 void EngineRepresentation::handleRunningAnalysisStatusChanges()
 {
-	if (_engineState != engineState::analysis)
+	if (_engineState != engineState::analysis || rewritingPlot())
 		return;
 
 	if(_analysisInProgress->isEmpty() || _analysisInProgress->isAborted())
@@ -361,7 +395,7 @@ void EngineRepresentation::sendStopEngine()
 	sendString(json.toStyledString());
 }
 
-void EngineRepresentation::restartEngine(QProcess * jaspEngineProcess)
+void EngineRepresentation::restartEngine(EngineProcess * jaspEngineProcess)
 {
 	Log::log() << "informing engine that it ought to restart" << std::endl;
 
@@ -370,6 +404,8 @@ void EngineRepresentation::restartEngine(QProcess * jaspEngineProcess)
 		_slaveProcess->kill();
 		delete _slaveProcess;
 		Log::log() << "EngineRepresentation::restartEngine says: Engine already has jaspEngine process!" << std::endl;
+
+		emit slaveProcessGone(channelNumber());
 	}
 
 	sendString("");
@@ -491,7 +527,7 @@ void EngineRepresentation::imageBackgroundChanged(QString value)
 
 void  EngineRepresentation::rerunRunningAnalysis()
 {
-	if(_engineState == engineState::analysis && _analysisInProgress != nullptr)
+	if(_engineState == engineState::analysis && _analysisInProgress != nullptr && !rewritingPlot())
 		_analysisInProgress->refresh();
 }
 
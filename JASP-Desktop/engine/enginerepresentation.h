@@ -2,7 +2,7 @@
 #define ENGINEREPRESENTATION_H
 
 #include <QObject>
-#include <QProcess>
+#include "engineprocess.h"
 #include <QTimer>
 #include <vector>
 
@@ -21,12 +21,13 @@ class EngineRepresentation : public QObject
 	Q_OBJECT
 
 public:
-	EngineRepresentation(IPCChannel * channel, QProcess * slaveProcess, QObject * parent = nullptr);
+	EngineRepresentation(IPCChannel * channel, EngineProcess * slaveProcess, QObject * parent = nullptr);
 	~EngineRepresentation();
 
 	void		clearAnalysisInProgress();
 	void		setAnalysisInProgress(Analysis* analysis);
 	Analysis *	analysisInProgress() const { return _analysisInProgress; }
+	bool		rewritingPlot()		const { return _plotInProgress != ""; }
 
 	bool isIdle() { return _engineState == engineState::idle; }
 
@@ -36,12 +37,13 @@ public:
 	void runScriptOnProcess(RScriptStore * scriptStore);
 	void runScriptOnProcess(RComputeColumnStore * computeColumnStore);
 	void runAnalysisOnProcess(Analysis *analysis);
+	void rewritePlotOnProcess(Analysis *analysis, const std::string & plotName);
 	void runModuleRequestOnProcess(Json::Value request);
 
 	void stopEngine();
 	void pauseEngine();
 	void resumeEngine();
-	void restartEngine(QProcess * jaspEngineProcess);
+	void restartEngine(EngineProcess * jaspEngineProcess);
 	bool paused()		const { return _engineState == engineState::paused;												}
 	bool initializing()	const { return _engineState == engineState::initializing;										}
 	bool resumed()		const { return _engineState != engineState::paused && _engineState != engineState::resuming;	}
@@ -94,20 +96,23 @@ signals:
 	void moduleUninstallingFinished(	const QString & moduleName);
 
 	void logCfgReplyReceived(int channelNr);
+	void slaveProcessGone(size_t channelNr); ///< The jaspEngine crashed, finished or was killed, so whatever it held in the data set can be released
 
 private:
 	void sendPauseEngine();
 	void sendStopEngine();
 	void rerunRunningAnalysis();
 	void setChannel(IPCChannel * channel)			{ _channel = channel; }
-	void setSlaveProcess(QProcess * slaveProcess);
+	void setSlaveProcess(EngineProcess * slaveProcess);
 
 private:
 	Analysis::Status analysisResultStatusToAnalysStatus(analysisResultStatus result, Analysis * analysis);
 
-	QProcess*	_slaveProcess		= nullptr;
+	EngineProcess*	_slaveProcess		= nullptr;
 	IPCChannel*	_channel			= nullptr;
 	Analysis*	_analysisInProgress = nullptr;
+	std::string	_plotInProgress		= ""; ///< Set when only a single plot of _analysisInProgress is being rewritten
+	int			_plotRewriteRevision	= -1; ///< Revision of _analysisInProgress when _plotInProgress was sent
 	engineState	_engineState		= engineState::initializing;
 	int			_ppi				= 96;
 	QString		_imageBackground	= "white";
@@ -22,6 +22,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
+#include <algorithm>
 
 
 #include <boost/interprocess/shared_memory_object.hpp>
@@ -36,9 +37,14 @@
 #include "timers.h"
 #include "utilities/appdirs.h"
 #include "log.h"
+#include "utilities/settings.h"
+#ifdef __linux__
+#include "enginezygote.h"
+#endif
 
 using namespace boost::interprocess;
 
+bool EngineSync::_useZygote = false;
 
 EngineSync::EngineSync(Analyses *analyses, DataSetPackage *package, DynamicModules *dynamicModules, QObject *parent = 0)
 	: QObject(parent), _analyses(analyses), _package(package), _dynamicModules(dynamicModules)
@@ -47,7 +53,8 @@ EngineSync::EngineSync(Analyses *analyses, DataSetPackage *package, DynamicModul
 	connect(_analyses,			&Analyses::analysisToRefresh,						this,					&EngineSync::ProcessAnalysisRequests			);
 	connect(_analyses,			&Analyses::analysisSaveImage,						this,					&EngineSync::ProcessAnalysisRequests			);
 	connect(_analyses,			&Analyses::analysisEditImage,						this,					&EngineSync::ProcessAnalysisRequests			);
-	connect(_analyses,			&Analyses::analysisRewriteImages,					this,					&EngineSync::ProcessAnalysisRequests			);
+	connect(_analyses,			&Analyses::analysisRewriteImages,					this,					&EngineSync::queuePlotRewrites					);
+	connect(_analyses,			&Analyses::analysisRemoved,							this,					&EngineSync::dropPlotRewrites					);
 	connect(_analyses,			&Analyses::analysisOptionsChanged,					this,					&EngineSync::ProcessAnalysisRequests			);
 	connect(_analyses,			&Analyses::sendRScript,								this,					&EngineSync::sendRCode							);
 	connect(this,				&EngineSync::moduleLoadingFailed,					_dynamicModules,		&DynamicModules::loadingFailed					);
@@ -86,6 +93,11 @@ void EngineSync::start(int ppi)
 #else
 		_engines.resize(4);
 #endif
+
+#ifdef __linux__
+		if(_useZygote || Settings::value(Settings::ENGINE_ZYGOTE).toBool())
+			startZygote();
+#endif
 		for(size_t i=0; i<_engines.size(); i++)
 		{
 			_engines[i] = new EngineRepresentation(new IPCChannel(_memoryName, i), startSlaveProcess(i), this);
@@ -103,6 +115,7 @@ void EngineSync::start(int ppi)
 			connect(_engines[i],	&EngineRepresentation::moduleUnloadingFinished,			this,			&EngineSync::moduleUnloadingFinishedHandler								);
 			connect(_engines[i],	&EngineRepresentation::moduleUninstallingFinished,		this,			&EngineSync::moduleUninstallingFinished									);
 			connect(_engines[i],	&EngineRepresentation::logCfgReplyReceived,				this,			&EngineSync::logCfgReplyReceived										);
+			connect(_engines[i],	&EngineRepresentation::slaveProcessGone,				this,			&EngineSync::releaseDataSnapshot										);
 			connect(this,			&EngineSync::ppiChanged,								_engines[i],	&EngineRepresentation::ppiChanged										);
 			connect(this,			&EngineSync::imageBackgroundChanged,					_engines[i],	&EngineRepresentation::imageBackgroundChanged							);
 			connect(_analyses,		&Analyses::analysisRemoved,								_engines[i],	&EngineRepresentation::analysisRemoved									);
@@ -154,6 +167,7 @@ void EngineSync::process()
 	processScriptQueue();
 	processDynamicModules();
 	ProcessAnalysisRequests();
+	processPlotRewrites();
 }
 
 void EngineSync::sendFilter(const QString & generatedFilter, const QString & filter, int requestID)
@@ -268,6 +282,10 @@ void EngineSync::ProcessAnalysisRequests()
 		bool canUseFirstEngine	= analysis->isEmpty()	|| analysis->isSaveImg() || analysis->isEditImg() || analysis->isRewriteImgs();
 		bool needsToRun			= canUseFirstEngine		|| analysis->isInited();
 
+		//Otherwise a plot still being rewritten with the old results could overwrite the one written by this run
+		if(needsToRun && plotRewriteInProgress(analysis))
+			return true;
+
 		if(needsToRun)
 			for (size_t i = canUseFirstEngine ? 0 : initedAnalysesStartIndex; i<_engines.size(); i++)
 				if (_engines[i]->isIdle())
@@ -282,15 +300,107 @@ void EngineSync::ProcessAnalysisRequests()
 
 }
 
-QProcess * EngineSync::startSlaveProcess(int no)
+void EngineSync::queuePlotRewrites(Analysis * analysis)
 {
-	QDir programDir			= QFileInfo( QCoreApplication::applicationFilePath() ).absoluteDir();
-	QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-	QString engineExe		= QFileInfo( QCoreApplication::applicationFilePath() ).absoluteDir().absoluteFilePath("JASPEngine");
+	dropPlotRewrites(analysis);
+
+	for(const std::string & plotName : analysis->plotNames())
+		_waitingPlotRewrites.push_back({ analysis, plotName, analysis->revision() });
+
+	processPlotRewrites();
+}
+
+void EngineSync::dropPlotRewrites(Analysis * analysis)
+{
+	_waitingPlotRewrites.erase(
+		std::remove_if(_waitingPlotRewrites.begin(), _waitingPlotRewrites.end(), [&](const PlotRewriteJob & job) { return job.analysis == analysis; }),
+		_waitingPlotRewrites.end());
+}
+
+///Each plot is a separate job, so they get spread over all idle engines (including the first) and the visible ones can go first.
+void EngineSync::processPlotRewrites()
+{
+	for(auto * engine : _engines)
+		while(engine->isIdle() && _waitingPlotRewrites.size() > 0)
+		{
+			auto job = std::find_if(_waitingPlotRewrites.begin(), _waitingPlotRewrites.end(), [&](const PlotRewriteJob & job) { return _visiblePlots.count(job.plotName) > 0; });
+
+			if(job == _waitingPlotRewrites.end())
+				job = _waitingPlotRewrites.begin();
+
+			PlotRewriteJob rewrite = *job;
+			_waitingPlotRewrites.erase(job);
+
+			//If the analysis is being (re)run, or was since this got queued, its plots will be written with the current ppi and background anyway
+			if(rewrite.analysis->isFinished() && rewrite.analysis->revision() == rewrite.revision)
+				engine->rewritePlotOnProcess(rewrite.analysis, rewrite.plotName);
+		}
+}
+
+bool EngineSync::plotRewriteInProgress(Analysis * analysis)
+{
+	for(auto * engine : _engines)
+		if(engine->rewritingPlot() && engine->analysisInProgress() == analysis)
+			return true;
+
+	return false;
+}
+
+void EngineSync::setVisiblePlots(const QStringList & plotNames)
+{
+	_visiblePlots.clear();
+
+	for(const QString & plotName : plotNames)
+		_visiblePlots.insert(plotName.toStdString());
+}
+
+EngineProcess * EngineSync::startSlaveProcess(int no)
+{
+#ifdef __linux__
+	if(_zygote != nullptr && _zygote->running())
+	{
+		EngineProcess * slave = _zygote->forkEngine(no);
+		connect(slave, &EngineProcess::finished, this, &EngineSync::subprocessFinished);
+
+		return slave;
+	}
+#endif
 
 	QStringList args;
 	args << QString::number(no) << QString::number(ProcessInfo::currentPID()) << QString::fromStdString(Log::logFileNameBase) << QString::fromStdString(Log::whereStr());
 
+	QProcess * slave = startEngineExecutable(args);
+
+	connect(slave, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),	this,	&EngineSync::subprocessFinished);
+	connect(slave, &QProcess::started,												this,	&EngineSync::subProcessStarted);
+	connect(slave, &QProcess::errorOccurred,										this,	&EngineSync::subProcessError);
+
+	return new EngineExecutableProcess(slave, this);
+}
+
+#ifdef __linux__
+///Starts a jaspEngine that initializes R once and from then on forks the engines, instead of having each of them start from scratch.
+void EngineSync::startZygote()
+{
+	if(_zygote == nullptr)
+	{
+		_zygote = new EngineZygote(this);
+		connect(_zygote, &EngineZygote::restartZygote, this, &EngineSync::startZygote);
+	}
+
+	QStringList args;
+	args << "zygote" << QString::number(ProcessInfo::currentPID()) << QString::fromStdString(Log::logFileNameBase) << QString::fromStdString(Log::whereStr()) << _zygote->serverName();
+
+	_zygote->setZygoteProcess(startEngineExecutable(args));
+}
+#endif
+
+QProcess * EngineSync::startEngineExecutable(const QStringList & args)
+{
+	QDir programDir			= QFileInfo( QCoreApplication::applicationFilePath() ).absoluteDir();
+	QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+	QString engineExe		= QFileInfo( QCoreApplication::applicationFilePath() ).absoluteDir().absoluteFilePath("JASPEngine");
+
 	env.insert("TMPDIR", tq(TempFiles::createTmpFolder()));
 
 #ifdef _WIN32
@@ -387,10 +497,6 @@ QProcess * EngineSync::startSlaveProcess(int no)
 	});
 #endif
 
-	connect(slave, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),	this,	&EngineSync::subprocessFinished);
-	connect(slave, &QProcess::started,												this,	&EngineSync::subProcessStarted);
-	connect(slave, &QProcess::errorOccurred,										this,	&EngineSync::subProcessError);
-
 	slave->start(engineExe, args);
 
 	return slave;
@@ -434,6 +540,13 @@ void EngineSync::subprocessFinished(int exitCode, QProcess::ExitStatus exitStatu
 	}
 }
 
+///Otherwise a pin of an engine that died mid-analysis would make every later edit copy columns for it
+void EngineSync::releaseDataSnapshot(size_t channelNr)
+{
+	if(_package->dataSet() != nullptr)
+		_package->dataSet()->releaseSnapshotSlot(channelNr);
+}
+
 void EngineSync::stopEngines()
 {
 	auto timeout = QDateTime::currentSecsSinceEpoch() + 60; //shouldnt take more than a minute
@@ -625,7 +738,7 @@ void EngineSync::refreshAllPlots()
 {
 	std::set<Analysis*> inProgress;
 	for(EngineRepresentation * engine : _engines)
-		if(engine->analysisInProgress() != nullptr)
+		if(engine->analysisInProgress() != nullptr && !engine->rewritingPlot())
 			inProgress.insert(engine->analysisInProgress());
 
 	emit refreshAllPlotsExcept(inProgress);
@@ -26,9 +26,20 @@
 #endif
 
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <deque>
 
 #include "enginerepresentation.h"
 
+class EngineZygote;
+
+///A single plot of an analysis that needs to be rewritten, for instance after the PPI or background changed.
+struct PlotRewriteJob
+{
+	Analysis *	analysis;
+	std::string	plotName;
+	int			revision; ///< Of analysis when it was queued, if it changed since then the plot will be written by its rerun
+};
+
 /* EngineSync is responsible for launching the background
  * processes, scheduling analyses, and for sending and
  * receiving communications with the running analyses.
@@ -47,6 +58,8 @@ public:
 	bool engineStarted()			{ return _engineStarted; }
 	bool allEnginesInitializing();
 
+	static void useZygote()			{ _useZygote = true; } ///< Use the zygote regardless of the setting, for instance for the sub-JASPs of --unitTestRecursive
+
 public slots:
 	void sendFilter(	const QString & generatedFilter,	const QString & filter,			int requestID);
 	void sendRCode(		const QString & rCode,				int requestId);
@@ -57,6 +70,7 @@ public slots:
 	void stopEngines();
 	void logCfgRequest();
 	void logToFileChanged(bool logToFile) { logCfgRequest(); }
+	void setVisiblePlots(const QStringList & plotNames);
 
 	
 signals:
@@ -85,8 +99,12 @@ private:
 	bool		allEnginesStopped();
 	bool		allEnginesPaused();
 	bool		allEnginesResumed();
-	QProcess*	startSlaveProcess(int no);
+	EngineProcess*	startSlaveProcess(int no);
+	QProcess*	startEngineExecutable(const QStringList & args);
+	void		startZygote();
 	void		processScriptQueue();
+	void		processPlotRewrites();
+	bool		plotRewriteInProgress(Analysis * analysis);
 	void		processLogCfgRequests();
 	void		processDynamicModules();
 	void		checkModuleWideCastDone();
@@ -96,6 +114,8 @@ private:
 
 private slots:
 	void ProcessAnalysisRequests();
+	void queuePlotRewrites(Analysis * analysis);
+	void dropPlotRewrites(Analysis * analysis);
 	void deleteOrphanedTempFiles();
 	void heartbeatTempFiles();
 
@@ -104,6 +124,7 @@ private slots:
 	void subProcessStarted();
 	void subProcessError(QProcess::ProcessError error);
 	void subprocessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+	void releaseDataSnapshot(size_t channelNr);
 
 	void moduleLoadingFailedHandler(		const QString & moduleName, const QString & errorMessage, int channelID);
 	void moduleLoadingSucceededHandler(		const QString & moduleName, int channelID);
@@ -120,8 +141,11 @@ private:
 	DynamicModules	*_dynamicModules	= nullptr;
 
 	std::queue<RScriptStore*>			_waitingScripts;
+	std::deque<PlotRewriteJob>			_waitingPlotRewrites;
+	std::set<std::string>				_visiblePlots;
 	std::vector<EngineRepresentation*>	_engines;
 	RFilterStore						*_waitingFilter = nullptr;
+	EngineZygote						*_zygote		= nullptr;
 
 	std::string _memoryName,
 				_engineInfo;
@@ -130,6 +154,8 @@ private:
 	Json::Value					_requestWideCastModuleJson		= Json::nullValue;
 	std::map<int, std::string>	_requestWideCastModuleResults;
 	std::set<size_t>			_logCfgRequested				= {};
+
+	static bool					_useZygote;
 };
 
 #endif // ENGINESYNC_H
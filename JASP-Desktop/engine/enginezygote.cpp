@@ -0,0 +1,235 @@
+#include "enginezygote.h"
+#include "processinfo.h"
+#include "log.h"
+#include <signal.h>
+#include <cerrno>
+
+void EngineZygoteProcess::terminate()	{ sendSignal(SIGTERM); }
+void EngineZygoteProcess::kill()		{ sendSignal(SIGKILL); }
+
+void EngineZygoteProcess::setPid(qint64 pid)
+{
+	_pid = pid;
+
+	if(_pendingSignal != 0)
+		sendSignal(_pendingSignal);
+}
+
+void EngineZygoteProcess::sendSignal(int signal)
+{
+	if(_pid > 0)	::kill(pid_t(_pid), signal);
+	else			_pendingSignal = signal;
+}
+
+EngineZygote::EngineZygote(QObject * parent) : QObject(parent)
+{
+	QString name = "JASP-Zygote-" + QString::number(ProcessInfo::currentPID());
+
+	_server = new QLocalServer(this);
+	QLocalServer::removeServer(name);
+
+	if(!_server->listen(name))
+		Log::log() << "EngineZygote could not listen on " << name.toStdString() << ": " << _server->errorString().toStdString() << std::endl;
+
+	connect(_server, &QLocalServer::newConnection, this, &EngineZygote::newConnection);
+
+	_orphanTimer = new QTimer(this);
+	_orphanTimer->setInterval(500);
+	connect(_orphanTimer, &QTimer::timeout, this, &EngineZygote::checkOrphans);
+}
+
+EngineZygote::~EngineZygote()
+{
+	stopAllForked();
+
+	if(_zygoteProcess != nullptr)
+	{
+		disconnect(_zygoteProcess, nullptr, this, nullptr);
+		_zygoteProcess->kill();
+		_zygoteProcess->waitForFinished(1000);
+	}
+}
+
+void EngineZygote::setZygoteProcess(QProcess * zygoteProcess)
+{
+	_zygoteProcess = zygoteProcess;
+	_zygoteProcess->setParent(this);
+
+	connect(_zygoteProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),	this, &EngineZygote::zygoteFinished);
+}
+
+EngineProcess * EngineZygote::forkEngine(int channel)
+{
+	EngineZygoteProcess * forked = new EngineZygoteProcess(this);
+
+	_waitingForPid[channel] = forked;
+	sendRequest("fork " + QString::number(channel));
+
+	return forked;
+}
+
+void EngineZygote::sendRequest(const QString & request)
+{
+	if(_socket == nullptr)	_pendingRequests.append(request); //The zygote is still initializing R
+	else					_socket->write((request + "\n").toUtf8());
+}
+
+void EngineZygote::newConnection()
+{
+	if(_socket != nullptr)
+		return;
+
+	_socket = _server->nextPendingConnection();
+	connect(_socket, &QLocalSocket::readyRead, this, &EngineZygote::readReplies);
+
+	Log::log() << "EngineZygote is ready to fork engines" << std::endl;
+
+	for(const QString & request : _pendingRequests)
+		sendRequest(request);
+
+	_pendingRequests.clear();
+}
+
+void EngineZygote::readReplies()
+{
+	while(_socket->canReadLine())
+	{
+		QStringList reply = QString::fromUtf8(_socket->readLine()).trimmed().split(' ');
+
+		if(reply.size() == 3 && reply[0] == "forked")
+		{
+			int		channel = reply[1].toInt();
+			qint64	pid		= reply[2].toLongLong();
+
+			if(_waitingForPid.count(channel) == 0)
+				continue;
+
+			QPointer<EngineZygoteProcess> forked = _waitingForPid[channel];
+			_waitingForPid.erase(channel);
+
+			if(forked.isNull())
+				::kill(pid_t(pid), SIGKILL); //Already got deleted, so nobody is going to talk to it
+			else
+			{
+				Log::log() << "Engine for channel " << channel << " forked from zygote with pid " << pid << std::endl;
+				_forked[pid] = forked;
+				forked->setPid(pid);
+			}
+		}
+		else if(reply.size() == 4 && reply[0] == "exited")
+		{
+			qint64	pid			= reply[1].toLongLong();
+			int		exitCode	= reply[2].toInt();
+			bool	crashed		= reply[3] != "0";
+
+			if(_forked.count(pid) == 0)
+				continue;
+
+			QPointer<EngineZygoteProcess> forked = _forked[pid];
+			_forked.erase(pid);
+
+			if(!forked.isNull())
+				emit forked->finished(exitCode, crashed ? QProcess::CrashExit : QProcess::NormalExit);
+		}
+		else if(reply.size() == 2 && reply[0] == "failed")
+		{
+			int channel = reply[1].toInt();
+
+			if(_waitingForPid.count(channel) == 0)
+				continue;
+
+			QPointer<EngineZygoteProcess> forked = _waitingForPid[channel];
+			_waitingForPid.erase(channel);
+
+			if(!forked.isNull())
+				emit forked->finished(-1, QProcess::CrashExit);
+		}
+		else
+			Log::log() << "EngineZygote got an unknown reply: " << reply.join(' ').toStdString() << std::endl;
+	}
+}
+
+void EngineZygote::stopAllForked()
+{
+	for(auto & pidForked : _forked)
+		::kill(pid_t(pidForked.first), SIGKILL);
+
+	for(auto & pidOrphan : _orphans)
+		::kill(pid_t(pidOrphan.first), SIGKILL);
+
+	for(auto & channelForked : _waitingForPid)
+		if(!channelForked.second.isNull())
+			channelForked.second->kill();
+}
+
+void EngineZygote::zygoteFinished(int exitCode, QProcess::ExitStatus)
+{
+	//A zygote that stops before it is ready would most likely do so again, so then engines are started from the executable from now on
+	bool restart = _socket != nullptr && _restarts < _maxRestarts;
+
+	if(_socket != nullptr)
+		readReplies(); //It might have forked some engines just before it stopped
+
+	Log::log() << "Engine zygote stopped with exitcode " << exitCode << (restart ? ", restarting it." : ", engines will be started from the executable from now on.") << std::endl;
+
+	_zygoteProcess->deleteLater();
+	_zygoteProcess = nullptr;
+
+	if(_socket != nullptr)
+		_socket->deleteLater();
+	_socket = nullptr;
+
+	//The engines it forked run on their own and keep going, but their exits have to be noticed some other way now
+	for(auto & pidForked : _forked)
+		_orphans[pidForked.first] = pidForked.second;
+	_forked.clear();
+
+	if(_orphans.size() > 0)
+		_orphanTimer->start();
+
+	_pendingRequests.clear();
+
+	if(restart)
+	{
+		//The new zygote gets the requests that were not answered yet once it connects
+		for(auto & channelForked : _waitingForPid)
+			_pendingRequests.append("fork " + QString::number(channelForked.first));
+
+		_restarts++;
+		emit restartZygote();
+		return;
+	}
+
+	std::vector<QPointer<EngineZygoteProcess>> unforked;
+
+	for(auto & channelForked : _waitingForPid)
+		unforked.push_back(channelForked.second);
+
+	_waitingForPid.clear();
+
+	for(auto & forked : unforked)
+		if(!forked.isNull())
+			emit forked->finished(-1, QProcess::CrashExit);
+}
+
+void EngineZygote::checkOrphans()
+{
+	std::vector<QPointer<EngineZygoteProcess>> exited;
+
+	for(auto orphan = _orphans.begin(); orphan != _orphans.end();)
+		if(orphan->second.isNull() || (::kill(pid_t(orphan->first), 0) != 0 && errno == ESRCH))
+		{
+			exited.push_back(orphan->second);
+			orphan = _orphans.erase(orphan);
+		}
+		else
+			orphan++;
+
+	if(_orphans.size() == 0)
+		_orphanTimer->stop();
+
+	//How it exited is unknown, but engines only stop by themselves when something went wrong
+	for(auto & orphan : exited)
+		if(!orphan.isNull())
+			emit orphan->finished(-1, QProcess::CrashExit);
+}
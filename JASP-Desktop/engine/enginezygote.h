@@ -0,0 +1,76 @@
+#ifndef ENGINEZYGOTE_H
+#define ENGINEZYGOTE_H
+
+#include <map>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QTimer>
+#include "engineprocess.h"
+
+///A jaspEngine forked from the zygote, it only gets its pid after the zygote replied.
+class EngineZygoteProcess : public EngineProcess
+{
+	Q_OBJECT
+
+public:
+	EngineZygoteProcess(QObject * parent = nullptr) : EngineProcess(parent) {}
+
+	void	terminate()	override;
+	void	kill()		override;
+
+	void	setPid(qint64 pid);
+	qint64	pid() const { return _pid; }
+
+private:
+	void	sendSignal(int signal);
+
+	qint64	_pid			= 0;
+	int		_pendingSignal	= 0;
+};
+
+///On linux a single jaspEngine is started as "zygote", it initializes R once and then forks a ready engine whenever one is needed.
+///That makes starting and restarting engines take milliseconds instead of seconds.
+///Requests and replies are single lines over a local socket:
+/// "fork <channel>" is answered by "forked <channel> <pid>" (or "failed <channel>") and whenever a forked engine stops the zygote sends "exited <pid> <exitCode> <crashed>".
+///Forked engines keep running when the zygote stops, only the zygote gets restarted.
+class EngineZygote : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit			EngineZygote(QObject * parent = nullptr);
+						~EngineZygote();
+
+	QString				serverName()	const	{ return _server->fullServerName();	}
+	bool				running()		const	{ return _zygoteProcess != nullptr;	}
+	void				setZygoteProcess(QProcess * zygoteProcess);
+	EngineProcess	*	forkEngine(int channel);
+
+signals:
+	void				restartZygote(); ///< The zygote stopped after it was ready, the receiver should start a new one and pass it to setZygoteProcess
+
+private slots:
+	void				newConnection();
+	void				readReplies();
+	void				zygoteFinished(int exitCode, QProcess::ExitStatus exitStatus);
+	void				checkOrphans();
+
+private:
+	void				sendRequest(const QString & request);
+	void				stopAllForked();
+
+	static const int									_maxRestarts	= 3;
+
+	QLocalServer									*	_server			= nullptr;
+	QLocalSocket									*	_socket			= nullptr;
+	QProcess										*	_zygoteProcess	= nullptr;
+	QStringList											_pendingRequests;
+	std::map<int,		QPointer<EngineZygoteProcess>>	_waitingForPid;
+	std::map<qint64,	QPointer<EngineZygoteProcess>>	_forked,
+														_orphans;		///< Forked by a zygote that stopped, so nobody tells us when they exit
+	QTimer											*	_orphanTimer	= nullptr;
+	int													_restarts		= 0;
+};
+
+#endif // ENGINEZYGOTE_H
@@ -103,6 +103,7 @@ bool	PreferencesModel::customThresholdScale()	const { return Settings::value(Set
 int		PreferencesModel::thresholdScale()			const { return Settings::value(Settings::THRESHOLD_SCALE							).toInt();					}
 bool	PreferencesModel::devModRegenDESC()			const { return Settings::value(Settings::DEVELOPER_MODE_REGENERATE_DESCRIPTION_ETC	).toBool();					}
 bool	PreferencesModel::logToFile()				const {	return Settings::value(Settings::LOG_TO_FILE								).toBool();					}
+bool	PreferencesModel::traceToFile()				const {	return Settings::value(Settings::TRACE_TO_FILE								).toBool();					}
 int		PreferencesModel::logFilesMax()				const {	return Settings::value(Settings::LOG_FILES_MAX								).toInt();					}
 int		PreferencesModel::maxFlickVelocity()		const {	return Settings::value(Settings::QML_MAX_FLICK_VELOCITY						).toInt();					}
 bool	PreferencesModel::modulesRemember()			const { return Settings::value(Settings::MODULES_REMEMBER							).toBool();					}
@@ -387,6 +388,15 @@ void PreferencesModel::setLogToFile(bool newLogToFile)
 	emit logToFileChanged(newLogToFile);
 }
 
+void PreferencesModel::setTraceToFile(bool newTraceToFile)
+{
+	if (traceToFile() == newTraceToFile)
+		return;
+
+	Settings::setValue(Settings::TRACE_TO_FILE, newTraceToFile);
+	emit traceToFileChanged(newTraceToFile);
+}
+
 void PreferencesModel::setLogFilesMax(int newLogFilesMax)
 {
 	if (logFilesMax() == newLogFilesMax)
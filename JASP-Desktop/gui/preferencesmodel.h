@@ -27,6 +27,7 @@ class PreferencesModel : public QObject
 	Q_PROPERTY(int			thresholdScale			READ thresholdScale				WRITE setThresholdScale				NOTIFY thresholdScaleChanged			)
 	Q_PROPERTY(bool			devModRegenDESC			READ devModRegenDESC			WRITE setDevModRegenDESC			NOTIFY devModRegenDESCChanged			)
 	Q_PROPERTY(bool			logToFile				READ logToFile					WRITE setLogToFile					NOTIFY logToFileChanged					)
+	Q_PROPERTY(bool			traceToFile				READ traceToFile				WRITE setTraceToFile				NOTIFY traceToFileChanged				)
 	Q_PROPERTY(int			logFilesMax				READ logFilesMax				WRITE setLogFilesMax				NOTIFY logFilesMaxChanged				)
 	Q_PROPERTY(int			maxFlickVelocity		READ maxFlickVelocity			WRITE setMaxFlickVelocity			NOTIFY maxFlickVelocityChanged			)
 	Q_PROPERTY(bool			modulesRemember			READ modulesRemember			WRITE setModulesRemember			NOTIFY modulesRememberChanged			)
@@ -56,6 +57,7 @@ public:
 	int			thresholdScale()			const;
 	bool		devModRegenDESC()			const;
 	bool		logToFile()					const;
+	bool		traceToFile()				const;
 	int			logFilesMax()				const;
 	int			maxFlickVelocity()			const;
 	bool		modulesRemember()			const;
@@ -90,6 +92,7 @@ public slots:
 	void setThresholdScale(int thresholdScale);
 	void setDevModRegenDESC(bool devModRegenDESC);
 	void setLogToFile(bool logToFile);
+	void setTraceToFile(bool traceToFile);
 	void setLogFilesMax(int logFilesMax);
 	void setMaxFlickVelocity(int maxFlickVelocity);	
 	void setModulesRemember(bool modulesRemember);
@@ -119,6 +122,7 @@ signals:
 	void thresholdScaleChanged(			int			thresholdScale);
 	void devModRegenDESCChanged(		bool		devModRegenDESC);
 	void logToFileChanged(				bool		logToFile);
+	void traceToFileChanged(			bool		traceToFile);
 	void logFilesMaxChanged(			int			logFilesMax);
 	void maxFlickVelocityChanged(		int			maxFlickVelocity);
 	void modulesRememberChanged(		bool		modulesRemember);
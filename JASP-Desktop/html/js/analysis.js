@@ -75,6 +75,7 @@ JASPWidgets.AnalysisView = JASPWidgets.View.extend({
 	initialize: function () {
 
 		this.viewNotes = { list: [] };
+		this.resultNodeViews = {};
 
 		this.toolbar = new JASPWidgets.Toolbar({ className: "jasp-toolbar  jasp-title-toolbar" })
 
@@ -504,7 +505,7 @@ JASPWidgets.AnalysisView = JASPWidgets.View.extend({
 
 	menuName: "Analysis",
 
-	createResultsViewFromMeta: function (results, resultsMeta, $result) {
+	createResultsViewFromMeta: function (results, resultsMeta, $result, nested) {
 		for (let i = 0; i < resultsMeta.length; i++) {
 
 			let meta = resultsMeta[i];
@@ -517,7 +518,7 @@ JASPWidgets.AnalysisView = JASPWidgets.View.extend({
 			if (meta.type == 'collection' && data.title == "") {  // remove collections without a title from view
 				let collectionMeta = meta.meta;
 				if (Array.isArray(collectionMeta)) { // the meta comes from a jaspResult analysis
-					this.createResultsViewFromMeta(data["collection"], collectionMeta, $result);
+					this.createResultsViewFromMeta(data["collection"], collectionMeta, $result, true);
 					continue;
 				}
 			}
@@ -531,12 +532,90 @@ JASPWidgets.AnalysisView = JASPWidgets.View.extend({
 			this.views.push(itemView);
 			this.volatileViews.push(itemView);
 
+			if (!nested)
+				this.resultNodeViews[name] = itemView;
+
 			itemView.render();
 			$result.append(itemView.$el);
 
 		}
 	},
 	
+	applyPatch: function (patch) {
+
+		var changed		= patch.analysis;
+		var results		= this.model.get("results");
+		var nodeNames	= _.keys(patch.results);
+
+		var incremental = results !== null && typeof results === "object" && _.has(results, ".meta") && !results.error &&
+			patch.removed.length === 0 && !_.has(changed, "results") && !_.has(changed, "status") &&
+			!_.contains(nodeNames, ".meta") && !_.contains(nodeNames, "title") && !_.contains(nodeNames, "error");
+
+		if (!_.has(changed, "results")) {
+			var patchedResults = _.extend({}, results, patch.results);
+			for (var i = 0; i < patch.removed.length; i++)
+				delete patchedResults[patch.removed[i]];
+
+			changed.results = patchedResults;
+		}
+
+		this.model.set(changed);
+
+		if (!incremental) {
+			this.render();
+			return;
+		}
+
+		if (_.has(changed, "progress")) {
+			var $progressbar = this.progressbar.init(this.model.get("progress"), this.model.get("id"), this.model.get("status"));
+			this.$el.find(".jasp-progressbar-container").replaceWith($progressbar);
+			this.handleVisibilityProgressbar(this.progressbar.status());
+		}
+
+		for (var i = 0; i < nodeNames.length; i++)
+			if (!this.reRenderResultNode(nodeNames[i])) {
+				this.render();
+				return;
+			}
+	},
+
+	reRenderResultNode: function (name) {
+
+		var results = this.model.get("results");
+		var oldView = this.resultNodeViews[name];
+		var data	= results[name];
+		var meta	= _.find(results[".meta"], function (entry) { return entry.name === name; });
+
+		if (oldView === undefined || meta === undefined || _.isArray(data) || (meta.type == 'collection' && data.title == "") ||
+			meta.type == "title" || meta.type == "h1" || meta.type == "h2")
+			return false;
+
+		for (var i = 0; i < this.viewNotes.list.length; i++)
+			if (this.viewNotes.list[i].noteDetails.path[0] === name)
+				this.viewNotes.list[i].widget.detach();
+
+		var $placeholder = $("<div></div>");
+		oldView.$el.before($placeholder);
+		oldView.close();
+
+		var itemView = this.createChild(data, this.model.get("status"), meta);
+		if (itemView === null) {
+			$placeholder.remove();
+			return false;
+		}
+
+		this.passUserDataToView([name], itemView);
+
+		this.views[this.views.indexOf(oldView)]					= itemView;
+		this.volatileViews[this.volatileViews.indexOf(oldView)]	= itemView;
+		this.resultNodeViews[name]								= itemView;
+
+		itemView.render();
+		$placeholder.replaceWith(itemView.$el);
+
+		return true;
+	},
+
 	setErrorOnPreviousResults: function (errorMessage, status, $lastResult, $result) {
 		if (errorMessage == null) // parser.parse() in the engine was unable to parse the R error message
 			errorMessage = "An unknown error occurred.";
@@ -690,6 +769,7 @@ JASPWidgets.AnalysisView = JASPWidgets.View.extend({
 
 		this.volatileViews = [];
 		this.views = [];
+		this.resultNodeViews = {};
 	},
 
 	onClose: function () {
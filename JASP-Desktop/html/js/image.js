@@ -164,7 +164,7 @@ JASPWidgets.imagePrimitive= JASPWidgets.View.extend({
 			html += '<div class="jasp-image-image"';
 			var id = data.replace(/[^A-Za-z0-9]/g, '-');
 			var url = window.globSet.tempFolder + data;
-			html += ' id="' + id + '" style="';
+			html += ' id="' + id + '" data-plot="' + data + '" style="';
 			html += 'background-image : url(\'' + url + '?x=' + Math.random() + '\'); '
 			html += 'background-size : 100% 100%">'
 		} else {
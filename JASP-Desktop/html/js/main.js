@@ -22,7 +22,8 @@ $(document).ready(function () {
 	window.globSet = {
 		"pExact" : false,
 		"decimals": "",
-		"tempFolder": ""
+		"tempFolder": "",
+		"tablePageSize": 0
 	}
 
 	var selectedAnalysisId = -1;
@@ -54,6 +55,37 @@ $(document).ready(function () {
 		}
 	}
 	
+	window.refreshRewrittenImage = function(id, plotName) {
+		// the file keeps its name, so only the cache has to be bypassed to show the new version
+		$("#results").find(".jasp-image-image").filter(function () { return $(this).attr("data-plot") === plotName; })
+			.css("background-image", "url('" + window.globSet.tempFolder + plotName + "?x=" + Math.random() + "')");
+	}
+
+	// lets the desktop rewrite the plots that are on screen first when the PPI or background changes
+	var reportVisiblePlotsTimer = null;
+	window.reportVisiblePlots = function () {
+		if (reportVisiblePlotsTimer !== null)
+			clearTimeout(reportVisiblePlotsTimer);
+
+		reportVisiblePlotsTimer = setTimeout(function () {
+			reportVisiblePlotsTimer = null;
+
+			if (jasp === null)
+				return;
+
+			var visible = [];
+			$("#results .jasp-image-image[data-plot]").each(function () {
+				var rect = this.getBoundingClientRect();
+				if (rect.bottom > 0 && rect.top < window.innerHeight)
+					visible.push($(this).attr("data-plot"));
+			});
+
+			jasp.visiblePlotsChanged(visible);
+		}, 250);
+	}
+
+	$(window).on("scroll resize", window.reportVisiblePlots);
+
 	window.cancelImageEdit = function(id) {
 		var analysis = analyses.getAnalysis(id);
 		if (analysis !== undefined)
@@ -553,6 +585,22 @@ $(document).ready(function () {
 		jaspWidget.render();
 	}
 
+	window.analysisPatched = function (patch) {
+
+		window.reportVisiblePlots(); // debounced, so it only looks once the analysis is rendered
+
+		if (patch.full) {
+			window.analysisChanged(patch.analysis);
+			return;
+		}
+
+		var jaspWidget = analyses.getAnalysis(patch.id);
+		if (jaspWidget === undefined)
+			console.log("Received a patch for analysis " + patch.id + " but it isn't shown, ignoring it.");
+		else
+			jaspWidget.applyPatch(patch);
+	}
+
 	$("#results").on("click", ".stack-trace-selector", function()
 	{
 		$(this).next(".stack-trace").slideToggle(function()
@@ -418,7 +418,21 @@ JASPWidgets.tableView = JASPWidgets.objectView.extend({
 
 JASPWidgets.tablePrimitive = JASPWidgets.View.extend({
 
+	page: 0,
+
 	render: function () {
+		this.renderRows(false);
+	},
+
+	//Tables with more rows than window.globSet.tablePageSize are shown one page at a time, exports always get all rows
+	isPaged: function () {
+		var pageSize = window.globSet.tablePageSize;
+		var optData = this.model.get("data");
+
+		return pageSize > 0 && optData !== undefined && optData !== null && optData.length > pageSize;
+	},
+
+	renderRows: function (allRows) {
 		var optSchema = this.model.get("schema");
 		var optData = this.model.get("data");
 		var optTitle = this.model.get("title");
@@ -434,6 +448,16 @@ JASPWidgets.tablePrimitive = JASPWidgets.View.extend({
 		var columnCount = columnDefs.length
 
 		let rowData = optData;
+		let paged = !allRows && this.isPaged();
+
+		if (paged) {
+			let pageSize = window.globSet.tablePageSize;
+			let pageCount = Math.ceil(optData.length / pageSize);
+
+			this.page = Math.max(0, Math.min(this.page, pageCount - 1));
+			rowData = optData.slice(this.page * pageSize, (this.page + 1) * pageSize);
+		}
+
 		let rowCount = rowData.length > 1 ? rowData.length : 1;
 
 		let columnsDict = createColumns(columnDefs, rowData, optFootnotes);
@@ -788,7 +812,32 @@ JASPWidgets.tablePrimitive = JASPWidgets.View.extend({
 
 		var html = chunks.join("");
 
+		this.$el.empty();
 		this.$el.append(html);
+
+		if (paged)
+			this.$el.append(this.pagerElement(optData.length));
+	},
+
+	pagerElement: function (rowCount) {
+		var self		= this;
+		var pageSize	= window.globSet.tablePageSize;
+		var firstRow	= this.page * pageSize;
+		var lastRow		= Math.min(firstRow + pageSize, rowCount);
+		var pageCount	= Math.ceil(rowCount / pageSize);
+
+		var $pager		= $('<div class="jasp-table-pager do-not-copy"></div>');
+		var $previous	= $('<button>&lt; Previous</button>').prop("disabled", this.page === 0);
+		var $next		= $('<button>Next &gt;</button>').prop("disabled", this.page >= pageCount - 1);
+
+		$previous.click(function () { self.page--; self.render(); });
+		$next.click(function () { self.page++; self.render(); });
+
+		$pager.append($previous);
+		$pager.append('<span>Rows ' + (firstRow + 1) + ' - ' + lastRow + ' of ' + rowCount + '</span>');
+		$pager.append($next);
+
+		return $pager;
 	},
 
 	getExportAttributes: function (element, exportParams) {
@@ -913,6 +962,14 @@ JASPWidgets.tablePrimitive = JASPWidgets.View.extend({
 
 			JASPWidgets.Exporter.begin(exportObject, newParams, callback, true);
 		}
+		else if (this.isPaged()) {
+			//Briefly render all rows so the export has the complete table, this all happens before the page gets repainted
+			this.renderRows(true);
+			var html = this.exportHTML(exportParams);
+			this.render();
+
+			callback.call(this, exportParams, new JASPWidgets.Exporter.data(null, html));
+		}
 		else
 			callback.call(this, exportParams, new JASPWidgets.Exporter.data(null, this.exportHTML(exportParams)));
 
@@ -20,14 +20,37 @@
 #include <QDir>
 
 #include "utilities/application.h"
+#include "utilities/unittestrunner.h"
+#include "engine/enginesync.h"
+#include "resultstesting/compareresults.h"
 #include <QQuickWindow>
 
 const std::string	jaspExtension	= ".jasp",
 					unitTestArg		= "--unitTest",
 					saveArg			= "--save",
-					timeOutArg		= "--timeOut=";
+					timeOutArg		= "--timeOut=",
+					jobsArg			= "--jobs=",
+					shardArg		= "--shard=",
+					reportArg		= "--report=",
+					compareJsonArg	= "--compareJson",
+					toleranceArg	= "--tolerance=",
+					zygoteArg		= "--engineZygote";
+
+bool parseIntArgument(const std::string & arg, int & value)
+{
+	size_t	convertedChars	= 0;
+	int		converted		= 0;
+	try								{ converted = std::stoi(arg, &convertedChars); }
+	catch(std::invalid_argument &)	{}
+	catch(std::out_of_range &)		{}
+
+	if(convertedChars > 0)
+		value = converted;
+
+	return convertedChars > 0;
+}
 
-void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitTest, bool & dirTest, int & timeOut, bool & save, bool & logToFile, bool & hideJASP)
+void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitTest, bool & dirTest, int & timeOut, bool & save, bool & logToFile, bool & hideJASP, int & jobs, int & shard, int & shardCount, std::string & reportPath, bool & compareJson, double & tolerance)
 {
 	filePath	= "";
 	unitTest	= false,
@@ -36,6 +59,12 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 	logToFile	= false;
 	hideJASP	= false;
 	timeOut		= 10;
+	jobs		= 1;
+	shard		= 0;
+	shardCount	= 1;
+	reportPath	= "";
+	compareJson	= false;
+	tolerance	= 1e-8;
 
 	bool letsExplainSomeThings = false;
 
@@ -95,16 +124,34 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 			}
 		}
 		else if(args[arg].size() > timeOutArg.size() && args[arg].substr(0, timeOutArg.size()) == timeOutArg)
+			parseIntArgument(args[arg].substr(timeOutArg.size()), timeOut);
+		else if(args[arg].size() > jobsArg.size() && args[arg].substr(0, jobsArg.size()) == jobsArg)
+			parseIntArgument(args[arg].substr(jobsArg.size()), jobs);
+		else if(args[arg].size() > reportArg.size() && args[arg].substr(0, reportArg.size()) == reportArg)
+			reportPath = args[arg].substr(reportArg.size());
+		else if(args[arg] == compareJsonArg)
+			compareJson = true;
+		else if(args[arg] == zygoteArg)
+			EngineSync::useZygote();
+		else if(args[arg].size() > toleranceArg.size() && args[arg].substr(0, toleranceArg.size()) == toleranceArg)
+		{
+			try								{ tolerance = std::stod(args[arg].substr(toleranceArg.size())); }
+			catch(std::invalid_argument &)	{ letsExplainSomeThings = true; }
+			catch(std::out_of_range &)		{ letsExplainSomeThings = true; }
+		}
+		else if(args[arg].size() > shardArg.size() && args[arg].substr(0, shardArg.size()) == shardArg)
 		{
-			std::string time			= timeOutArg.substr(timeOutArg.size());
-			size_t		convertedChars	= 0;
-			int			convertedTime	= 0;
-			try								{ convertedTime = std::stoi(time, &convertedChars); }
-			catch(std::invalid_argument &)	{}
-			catch(std::out_of_range &)		{}
-
-			if(convertedChars > 0)
-				timeOut = convertedTime;
+			std::string shardSpec	= args[arg].substr(shardArg.size());
+			size_t		slash		= shardSpec.find('/');
+			int			oneBased	= 0;
+
+			if(slash == std::string::npos || !parseIntArgument(shardSpec.substr(0, slash), oneBased) || !parseIntArgument(shardSpec.substr(slash + 1), shardCount) || oneBased < 1 || oneBased > shardCount)
+			{
+				std::cerr << "Shard should be specified as --shard=i/n with 1 <= i <= n, not as " << args[arg] << std::endl;
+				letsExplainSomeThings = true;
+			}
+			else
+				shard = oneBased - 1;
 		}
 		else
 		{
@@ -137,11 +184,16 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 
 	if(letsExplainSomeThings)
 	{
-		std::cout	<< "JASP can be started without arguments, or the following: { filename | --unitTest filename | --unitTestRecursive folder | --save | --timeOut=10 | --logToFile | --hide } \n"
+		std::cout	<< "JASP can be started without arguments, or the following: { filename | --unitTest filename | --unitTestRecursive folder | --save | --timeOut=10 | --jobs=1 | --shard=1/1 | --report=file.json | --compareJson | --tolerance=1e-8 | --engineZygote | --logToFile | --hide } \n"
 					<< "If a filename is supplied JASP will try to load it. \nIf --unitTest is specified JASP will refresh all analyses in \"filename\" (which must be a JASP file) and see if the output remains the same and will then exit with an errorcode indicating succes or failure.\n"
 					<< "If --unitTestRecursive is specified JASP will go through specified \"folder\" and perform a --unitTest on each JASP file. After it has done this it will exit with an errorcode indication succes or failure.\n"
 					<< "For both testing arguments there is the optional --save argument, which specifies that JASP should save the file after refreshing it.\n"
 					<< "For both testing arguments there is the optional --timeout argument, which specifies how many minutes JASP will wait for the analyses-refresh to take. Default is 10 minutes.\n"
+					<< "For --unitTestRecursive the optional --jobs argument specifies how many JASP files are tested at the same time, default is 1.\n"
+					<< "For --unitTestRecursive the optional --shard=i/n argument makes JASP only test every n-th file starting with the i-th, so the files can be spread over n invocations.\n"
+					<< "For --unitTestRecursive the optional --report argument specifies a file to which the outcome and timing of each JASP file is written as JSON.\n"
+					<< "For both testing arguments there is the optional --compareJson argument, which compares the results of the analyses as stored in the JASP file instead of the exported html. Numbers may then differ by --tolerance (relative), default is 1e-8.\n"
+					<< "If --engineZygote is specified then JASP forks its engines from a single initialized one (only on linux), whatever the preference says. --unitTestRecursive passes it on to every file it tests.\n"
 					<< "If --logToFile is specified then JASP will try it's utmost to write logging to a file, this might come in handy if you want to figure out why JASP does not start in case of a bug.\n"
 					<< "If --hide is specified then JASP will not be shown during recursive testing.\n"
 					<< std::flush;
@@ -150,80 +202,6 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 	}
 }
 
-#define SEPARATE_PROCESS
-
-void recursiveFileOpener(QFileInfo file, int & failures, int & total, int & timeOut, int argc, char *argv[], bool save, bool hideJASP)
-{
-	const QString jaspExtension(".jasp");
-
-	//std::cout << "recursiveFileOpener in " << file.absoluteFilePath().toStdString() << std::endl;
-
-	if(file.isDir())
-	{
-		//std::cout << "it is a directory and " << (file.exists() ? "exists" : "does not exist") << std::endl;
-
-		QDir dir(file.absoluteFilePath());
-
-		//std::cout << "QDir dir: " << dir.path().toStdString() << " has " << files.size() << " subfiles!" << std::endl;
-
-		for(QFileInfo subFile : dir.entryInfoList(QDir::Filter::NoDotAndDotDot | QDir::Files | QDir::Dirs))
-			recursiveFileOpener(subFile, failures, total, timeOut, argc, argv, save, hideJASP);
-
-	}
-	else if(file.isFile())
-	{
-		//std::cout << "it is a file" << std::endl;
-
-		if(file.absoluteFilePath().indexOf(jaspExtension) == file.absoluteFilePath().size() - jaspExtension.size())
-		{
-			//std::cout << "it has the .jasp extension so we will start JASP" << std::endl;
-#ifndef SEPARATE_PROCESS
-			std::cout << "Found a JASP file (" << file.absoluteFilePath().toStdString() << ") going to start JASP" << std::endl;
-#endif
-
-			int result = 1;
-
-			try{
-#ifdef SEPARATE_PROCESS
-				QProcess subJasp;
-				subJasp.setProgram(argv[0]);
-				QStringList arguments({"--unitTest", file.absoluteFilePath()});
-
-				if(save)
-					arguments << "--save";
-
-				arguments << QString::fromStdString("--timeOut="+std::to_string(timeOut));
-
-				if(hideJASP)
-					arguments << "-platform" << "minimal";
-
-				std::cout << "Starting subJASP with args: " << arguments.join(' ').toStdString() << std::endl;
-				subJasp.setArguments(arguments);
-				subJasp.start();
-
-				subJasp.waitForFinished((timeOut * 60000) + 10000);
-
-				std::cerr << subJasp.readAllStandardError().toStdString() << std::endl;
-
-				result = subJasp.exitCode();
-#else
-				//This seems to crash for some reason
-				result = Application(argc, argv, file.absoluteFilePath(), true, timeOut).exec();
-#endif
-			}
-			catch(...) { result = -1; }
-
-
-			std::cout << "JASP file " << file.absoluteFilePath().toStdString() << (result == 0 ? " succeeded!" : " failed!") << std::endl;
-
-			if(result != 0)
-				failures++;
-
-			total++;
-		}
-	}
-}
-
 int main(int argc, char *argv[])
 {
 #ifdef _WIN32
@@ -241,9 +219,18 @@ int main(int argc, char *argv[])
 				save,
 				logToFile,
 				hideJASP;
-	int			timeOut;
+	int			timeOut,
+				jobs,
+				shard,
+				shardCount;
+	std::string	reportPath;
+	double		tolerance;
+	bool		compareJson;
+
+	parseArguments(argc, argv, filePath, unitTest, dirTest, timeOut, save, logToFile, hideJASP, jobs, shard, shardCount, reportPath, compareJson, tolerance);
 
-	parseArguments(argc, argv, filePath, unitTest, dirTest, timeOut, save, logToFile, hideJASP);
+	if(compareJson)
+		resultXmlCompare::compareResults::theOne()->enableJsonComparison(tolerance);
 
 	QString filePathQ(QString::fromStdString(filePath));
 
@@ -284,10 +271,20 @@ int main(int argc, char *argv[])
 		}
 	else
 	{
-		int		failures	= 0,
-				total		= 0;
+		QStringList compareArguments;
+		if(compareJson)
+			compareArguments << QString::fromStdString(compareJsonArg) << QString::fromStdString(toleranceArg) + QString::number(tolerance, 'g', 17); //std::to_string would turn 1e-8 into "0.000000"
+
+		UnitTestRunner runner(argv[0], timeOut, save, hideJASP, jobs, shard, shardCount, compareArguments);
+
+		runner.collectFiles(QFileInfo(filePathQ));
+		runner.run();
+
+		if(reportPath != "")
+			runner.writeReport(QString::fromStdString(reportPath));
 
-		recursiveFileOpener(QFileInfo(filePathQ), failures, total, timeOut, argc, argv, save, hideJASP);
+		size_t	failures	= runner.failures(),
+				total		= runner.total();
 
 		if(total == 0)
 		{
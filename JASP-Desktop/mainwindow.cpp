@@ -55,6 +55,7 @@
 #include "modules/analysismenumodel.h"
 
 #include "timers.h"
+#include "tracer.h"
 #include "resultstesting/compareresults.h"
 #include "widgets/filemenu/filemenu.h"
 #include "gui/messageforwarder.h"
@@ -98,6 +99,7 @@ MainWindow::MainWindow(QApplication * application) : QObject(application), _appl
 	JASPTIMER_START(MainWindowConstructor);
 
 	TempFiles::init(ProcessInfo::currentPID()); // needed here so that the LRNAM can be passed the session directory
+	SharedMemory::setUseMappedFile(Settings::value(Settings::DATA_IN_MAPPED_FILE).toBool());
 
 	makeAppleMenu(); //Doesnt do anything outside of magical apple land
 
@@ -162,6 +164,9 @@ MainWindow::~MainWindow()
 
 	delete _resultsJsInterface;
 	delete _engineSync;
+
+	Tracer::setEnabled(false); //Writes out the trace, if any
+
 	if (_package && _package->dataSet())
 	{
 		_loader.free(_package->dataSet());
@@ -254,6 +259,8 @@ void MainWindow::makeConnections()
 	connect(_analyses,				&Analyses::showAnalysisInResults,					_resultsJsInterface,	&ResultsJsInterface::showAnalysis							);
 	connect(_analyses,				&Analyses::unselectAnalysisInResults,				_resultsJsInterface,	&ResultsJsInterface::unselect								);
 	connect(_analyses,				&Analyses::analysisImageEdited,						_resultsJsInterface,	&ResultsJsInterface::analysisImageEditedHandler				);
+	connect(_analyses,				&Analyses::analysisImageRewritten,					_resultsJsInterface,	&ResultsJsInterface::analysisImageRewrittenHandler			);
+	connect(_resultsJsInterface,	&ResultsJsInterface::visiblePlotsChanged,			_engineSync,			&EngineSync::setVisiblePlots								);
 	connect(_analyses,				&Analyses::analysisRemoved,							_resultsJsInterface,	&ResultsJsInterface::removeAnalysis							);
     connect(_analyses,				&Analyses::analysesExportResults,					_fileMenu,				&FileMenu::analysesExportResults							);
 	connect(_analyses,				&Analyses::somethingModified,						[&](){					if(_package) _package->setModified(true); }					);
@@ -355,8 +362,13 @@ void MainWindow::initLog()
 	Log::setLoggingToFile(_preferences->logToFile());
 	logRemoveSuperfluousFiles(_preferences->logFilesMax());
 
+	Tracer::setOutputFile(Log::logFileNameBase + " Desktop.trace.json");
+	Tracer::setEnabled(_preferences->traceToFile());
+
 	connect(_preferences, &PreferencesModel::logToFileChanged,		this,			&MainWindow::logToFileChanged									); //Not connecting preferences directly to Log to keep it Qt-free (for Engine/R-Interface)
 	connect(_preferences, &PreferencesModel::logToFileChanged,		_engineSync,	&EngineSync::logToFileChanged,			Qt::QueuedConnection	);
+	connect(_preferences, &PreferencesModel::traceToFileChanged,	this,			&MainWindow::traceToFileChanged									);
+	connect(_preferences, &PreferencesModel::traceToFileChanged,	_engineSync,	&EngineSync::logToFileChanged,			Qt::QueuedConnection	); //The engines get their tracing switched through the logCfg message as well
 	connect(_preferences, &PreferencesModel::logFilesMaxChanged,	this,			&MainWindow::logRemoveSuperfluousFiles							);
 }
 
@@ -365,11 +377,16 @@ void MainWindow::logToFileChanged(bool logToFile)
 	Log::setLoggingToFile(logToFile);
 }
 
+void MainWindow::traceToFileChanged(bool traceToFile)
+{
+	Tracer::setEnabled(traceToFile);
+}
+
 void MainWindow::logRemoveSuperfluousFiles(int maxFilesToKeep)
 {
 	QDir logFileDir(AppDirs::logDir());
 
-	QFileInfoList logs = logFileDir.entryInfoList({"*.log"}, QDir::Filter::Files, QDir::SortFlag::Name | QDir::SortFlag::Reversed);
+	QFileInfoList logs = logFileDir.entryInfoList({"*.log", "*.trace.json"}, QDir::Filter::Files, QDir::SortFlag::Name | QDir::SortFlag::Reversed);
 
 	if(logs.size() < maxFilesToKeep)
 		return;
@@ -1371,8 +1388,18 @@ void MainWindow::finishComparingResults()
 {
 	if(resultXmlCompare::compareResults::theOne()->testMode() && resultXmlCompare::compareResults::theOne()->exportCalled() && !resultXmlCompare::compareResults::theOne()->comparedAlready())
 	{
-		std::string resultHtml = _package->analysesHTML();
-		resultXmlCompare::compareResults::theOne()->setRefreshResult(QString::fromStdString(resultHtml));
+		if(resultXmlCompare::compareResults::theOne()->jsonComparison())
+		{
+			Json::Value analysesJson = Json::arrayValue;
+			_analyses->applyToAll([&](Analysis * analysis) { analysesJson.append(analysis->asJSON()); });
+
+			resultXmlCompare::compareResults::theOne()->setRefreshAnalyses(analysesJson);
+		}
+		else
+		{
+			std::string resultHtml = _package->analysesHTML();
+			resultXmlCompare::compareResults::theOne()->setRefreshResult(QString::fromStdString(resultHtml));
+		}
 
 		resultXmlCompare::compareResults::theOne()->compare();
 
@@ -218,6 +218,7 @@ private slots:
 	void unitTestTimeOut();
 	void saveJaspFileHandler();
 	void logToFileChanged(bool logToFile);
+	void traceToFileChanged(bool traceToFile);
 	void logRemoveSuperfluousFiles(int maxFilesToKeep);
 
 private:
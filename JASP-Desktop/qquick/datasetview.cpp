@@ -43,7 +43,8 @@ void DataSetView::setModel(QAbstractTableModel * model)
 {
 	if(_model != model)
 	{
-		_model = model;
+		_model			= model;
+		_blockSource	= dynamic_cast<DataSetViewBlockSource*>(model);
 
 		connect(_model, &QAbstractTableModel::dataChanged,			this, &DataSetView::modelDataChanged);
 		connect(_model, &QAbstractTableModel::headerDataChanged,	this, &DataSetView::modelHeaderDataChanged);
@@ -52,6 +53,8 @@ void DataSetView::setModel(QAbstractTableModel * model)
 
 		setRolenames();
 
+		_modelHasMaxColStrings = _model->metaObject()->indexOfMethod("maxColStrings(int,int)") != -1;
+
 		QSizeF calcedSizeRowNumber = _metricsFont.size(Qt::TextSingleLine, QString::fromStdString(std::to_string(_model->rowCount()) + "XXX"));
 		setRowNumberWidth(calcedSizeRowNumber.width() + 30);
 
@@ -82,6 +85,7 @@ void DataSetView::calculateCellSizes()
 
 	_cellSizes.clear();
 	_dataColsMaxWidth.clear();
+	_colWidthTree.clear();
 
 	for(auto col : _cellTextItems)
 	{
@@ -107,18 +111,14 @@ void DataSetView::calculateCellSizes()
 	if(_model == nullptr) return;
 
 	_cellSizes.resize(_model->columnCount());
-	_colXPositions.resize(_model->columnCount());
 	_cellTextItems.clear();
 
 	_metricsFont = QFontMetricsF(_font);
 
-	for(int col=0; col<_model->columnCount(); col++)
-	{
-		QString text = _model->headerData(col, Qt::Orientation::Horizontal, _roleNameToRole["maxColString"]).toString();
-		QSizeF calcedSize = _metricsFont.size(Qt::TextSingleLine, text);
+	QStringList texts = maxColStrings(0, _model->columnCount() - 1);
 
-		_cellSizes[col] = calcedSize;
-	}
+	for(int col=0; col<_model->columnCount(); col++)
+		_cellSizes[col] = _metricsFont.size(Qt::TextSingleLine, texts[col]);
 
 	_dataColsMaxWidth.resize(_model->columnCount());
 
@@ -127,20 +127,10 @@ void DataSetView::calculateCellSizes()
 
 	setHeaderHeight(_model->columnCount() == 0 ? 0 : _cellSizes[0].height() + _itemVerticalPadding * 2);
 
-	float w = _rowNumberMaxWidth;
-	for(int col=0; col<_model->columnCount(); col++)
-		w += _dataColsMaxWidth[col];
-
-
-	float x = _rowNumberMaxWidth;
-
-	for(int col=0; col<_model->columnCount(); col++)
-	{
-		_colXPositions[col] = x;
-		x += _dataColsMaxWidth[col];
-	}
+	rebuildColWidthTree();
 
-	_dataWidth = w;
+	_dataWidth			= colXPosition(_model->columnCount());
+	_laidOutRowCount	= _model->rowCount();
 
 	setWidth(	(_extraColumnItem != nullptr ? _dataRowsMaxHeight : 0 ) + _dataWidth					);
 	setHeight(	_dataRowsMaxHeight * (_model->rowCount() + 1)	);
@@ -150,10 +140,234 @@ void DataSetView::calculateCellSizes()
 
 	_storedLineFlags.clear();
 	_storedDisplayText.clear();
+	_storedActive.clear();
 
 	JASPTIMER_STOP(calculateCellSizes);
 }
 
+///Uses the batched maxColStrings of the model when it has one, otherwise asks headerData for each column
+QStringList DataSetView::maxColStrings(int colFirst, int colLast)
+{
+	QStringList texts;
+
+	if(_modelHasMaxColStrings)
+		QMetaObject::invokeMethod(_model, "maxColStrings", Qt::DirectConnection, Q_RETURN_ARG(QStringList, texts), Q_ARG(int, colFirst), Q_ARG(int, colLast));
+
+	if(texts.size() != colLast - colFirst + 1)
+	{
+		texts.clear();
+		for(int col=colFirst; col<=colLast; col++)
+			texts.append(_model->headerData(col, Qt::Orientation::Horizontal, _roleNameToRole["maxColString"]).toString());
+	}
+
+	return texts;
+}
+
+bool DataSetView::layoutNeedsFullRecalculation() const
+{
+	return _model == nullptr || _dataColsMaxWidth.size() != size_t(_model->columnCount()) || _laidOutRowCount != _model->rowCount();
+}
+
+void DataSetView::modelDataChanged(const QModelIndex & topLeft, const QModelIndex & bottomRight, const QVector<int> &)
+{
+	if(layoutNeedsFullRecalculation() || !topLeft.isValid() || !bottomRight.isValid())
+	{
+		calculateCellSizes();
+		return;
+	}
+
+	JASPTIMER_RESUME(modelDataChanged);
+
+	int	rowFirst = std::max(0, topLeft.row()),		rowLast = std::min(_model->rowCount()		- 1, bottomRight.row()),
+		colFirst = std::max(0, topLeft.column()),	colLast = std::min(_model->columnCount()	- 1, bottomRight.column());
+
+	forgetCells(rowFirst, rowLast, colFirst, colLast);
+
+	int firstResized = remeasureColumns(colFirst, colLast);
+
+	//Only the changed cells that are on screen get recreated, the others will get fresh data whenever they are scrolled into view
+	for(int col=std::max(colFirst, _previousViewportColMin); col<=std::min(colLast, _previousViewportColMax - 1); col++)
+		for(int row=std::max(rowFirst, _previousViewportRowMin); row<=std::min(rowLast, _previousViewportRowMax - 1); row++)
+			storeTextItem(row, col);
+
+	if(firstResized != -1)
+		repositionItemsFrom(firstResized);
+
+	viewportChanged();
+
+	JASPTIMER_STOP(modelDataChanged);
+}
+
+void DataSetView::modelHeaderDataChanged(Qt::Orientation orientation, int first, int last)
+{
+	if(layoutNeedsFullRecalculation())
+	{
+		calculateCellSizes();
+		return;
+	}
+
+	JASPTIMER_RESUME(modelHeaderDataChanged);
+
+	first = std::max(0, first);
+
+	if(orientation == Qt::Horizontal)
+	{
+		last = std::min(_model->columnCount() - 1, last);
+
+		int firstResized = remeasureColumns(first, last);
+
+		for(int col=first; col<=last; col++)
+			storeColumnHeader(col);
+
+		if(firstResized != -1)
+			repositionItemsFrom(firstResized);
+	}
+	else
+	{
+		last = std::min(_model->rowCount() - 1, last);
+
+		for(int row=first; row<=last; row++)
+			storeRowNumber(row);
+	}
+
+	viewportChanged();
+
+	JASPTIMER_STOP(modelHeaderDataChanged);
+}
+
+///Drops the cached display text and lineflags of a range of cells, without going through every cell that was never looked at
+void DataSetView::forgetCells(int rowFirst, int rowLast, int colFirst, int colLast)
+{
+	for(auto row = _storedLineFlags.lower_bound(rowFirst); row != _storedLineFlags.end() && int(row->first) <= rowLast; row++)
+		row->second.erase(row->second.lower_bound(colFirst), row->second.upper_bound(colLast));
+
+	for(auto row = _storedDisplayText.lower_bound(rowFirst); row != _storedDisplayText.end() && int(row->first) <= rowLast; row++)
+		row->second.erase(row->second.lower_bound(colFirst), row->second.upper_bound(colLast));
+
+	for(auto row = _storedActive.lower_bound(rowFirst); row != _storedActive.end() && int(row->first) <= rowLast; row++)
+		row->second.erase(row->second.lower_bound(colFirst), row->second.upper_bound(colLast));
+}
+
+///Measures the columns again and returns the first one that changed width, or -1 if none did
+int DataSetView::remeasureColumns(int colFirst, int colLast)
+{
+	int			firstResized	= -1;
+	QStringList	texts			= maxColStrings(colFirst, colLast);
+
+	for(int col=colFirst; col<=colLast; col++)
+	{
+		_cellSizes[col]	= _metricsFont.size(Qt::TextSingleLine, texts[col - colFirst]);
+
+		float width = _cellSizes[col].width() + _itemHorizontalPadding * 2;
+
+		if(width != _dataColsMaxWidth[col])
+		{
+			colWidthTreeAdd(col, width - _dataColsMaxWidth[col]);
+			_dataColsMaxWidth[col] = width;
+
+			if(firstResized == -1)
+				firstResized = col;
+		}
+	}
+
+	if(firstResized != -1)
+	{
+		_dataWidth = colXPosition(_model->columnCount());
+		setWidth((_extraColumnItem != nullptr ? _dataRowsMaxHeight : 0 ) + _dataWidth);
+	}
+
+	return firstResized;
+}
+
+///Moves the items that are alive from colFirst onwards to their new x-position, the other columns stay exactly where they were
+void DataSetView::repositionItemsFrom(int colFirst)
+{
+	for(auto & col : _cellTextItems)
+		if(col.first >= colFirst)
+		{
+			float x = colXPosition(col.first);
+
+			for(auto & row : col.second)
+				if(row.second != nullptr)
+				{
+					QQuickItem * textItem = row.second->item;
+
+					if(QString(textItem->metaObject()->className()) != "QQuickText")
+						textItem->setWidth(_dataColsMaxWidth[col.first]);
+					textItem->setX(x + _itemHorizontalPadding);
+				}
+		}
+
+	for(auto & col : _columnHeaderItems)
+		if(col.first >= colFirst && col.second != nullptr)
+		{
+			col.second->item->setWidth(_dataColsMaxWidth[col.first]);
+			col.second->item->setX(colXPosition(col.first));
+		}
+}
+
+///The lowest set bit of i, i & -i would negate an unsigned value (MSVC warning C4146)
+static size_t lowestBit(size_t i) { return i & (~i + 1); }
+
+void DataSetView::rebuildColWidthTree()
+{
+	size_t cols = _dataColsMaxWidth.size();
+
+	_colWidthTree.assign(cols + 1, 0);
+
+	for(size_t i=1; i<=cols; i++)
+	{
+		_colWidthTree[i] += _dataColsMaxWidth[i - 1];
+
+		size_t parent = i + lowestBit(i);
+		if(parent <= cols)
+			_colWidthTree[parent] += _colWidthTree[i];
+	}
+}
+
+void DataSetView::colWidthTreeAdd(int col, float delta)
+{
+	for(size_t i=col + 1; i<_colWidthTree.size(); i += lowestBit(i))
+		_colWidthTree[i] += delta;
+}
+
+///The left side of col, so including the rownumbers
+float DataSetView::colXPosition(int col) const
+{
+	float x = _rowNumberMaxWidth;
+
+	if(_colWidthTree.size() == 0)
+		return x;
+
+	for(size_t i=std::min(size_t(col), _colWidthTree.size() - 1); i>0; i -= lowestBit(i))
+		x += _colWidthTree[i];
+
+	return x;
+}
+
+///The number of columns that end at or before x, not counting the rownumbers. So also the index of the column that contains x.
+int DataSetView::colAtX(float x) const
+{
+	if(_colWidthTree.size() < 2)
+		return 0;
+
+	size_t	cols	= _colWidthTree.size() - 1,
+			pos		= 0,
+			step	= 1;
+
+	while(step * 2 <= cols)
+		step *= 2;
+
+	for(; step > 0; step /= 2)
+		if(pos + step <= cols && _colWidthTree[pos + step] <= x)
+		{
+			pos	+= step;
+			x	-= _colWidthTree[pos];
+		}
+
+	return int(pos);
+}
+
 void DataSetView::viewportChanged()
 {
 	if(_model == nullptr || _viewportX != _viewportX || _viewportY != _viewportY || _viewportW != _viewportW || _viewportH != _viewportH ) //only possible if they are NaN
@@ -189,22 +403,8 @@ void DataSetView::determineCurrentViewPortIndices()
 	QVector2D viewSize(_viewportW, _viewportH);
 	QVector2D rightBottom(leftTop + viewSize);
 
-	_currentViewportColMax = -1;
-	_currentViewportColMin = -1;
-
-	float cumulative = 0;
-	for(int col=0; col<_model->columnCount() && _currentViewportColMax == -1; col++)
-	{
-		if(_currentViewportColMax == -1 && cumulative > rightBottom.x())						_currentViewportColMax = col;
-
-		float prevCum = cumulative;
-		cumulative += _dataColsMaxWidth[col];
-
-		if(_currentViewportColMin == -1 && cumulative > leftTop.x() && prevCum < leftTop.x())	_currentViewportColMin = col;
-	}
-
-	if(_currentViewportColMax == -1)
-		_currentViewportColMax = _model->columnCount();
+	_currentViewportColMin = colAtX(leftTop.x());
+	_currentViewportColMax = std::min(_model->columnCount(), colAtX(rightBottom.x()) + 1);
 
 	_currentViewportColMin = std::max(0,										_currentViewportColMin - _viewportMargin);
 	_currentViewportColMax = std::max(0, std::min(_model->columnCount(),		_currentViewportColMax + _viewportMargin));
@@ -273,6 +473,59 @@ void DataSetView::addLine(float x0, float y0, float x1, float y1)
 	_lines[_linesActualSize++] = y1;
 }
 
+///Gets all visible cells that weren't stored yet from the model in a single block, when it supports that, instead of through data() per cell and role
+void DataSetView::fetchMissingCells()
+{
+	if(_blockSource == nullptr)
+		return;
+
+	JASPTIMER_RESUME(fetchMissingCells);
+
+	int	rowMin = _currentViewportRowMax, rowMax = -1,
+		colMin = _currentViewportColMax, colMax = -1;
+
+	for(int row=_currentViewportRowMin; row<_currentViewportRowMax; row++)
+	{
+		auto	flags	= _storedLineFlags.find(row),
+				active	= _storedActive.find(row);
+		auto	text	= _storedDisplayText.find(row);
+
+		for(int col=_currentViewportColMin; col<_currentViewportColMax; col++)
+			if(	flags	== _storedLineFlags.end()	|| flags->second.count(col)		== 0 ||
+				active	== _storedActive.end()		|| active->second.count(col)	== 0 ||
+				text	== _storedDisplayText.end()	|| text->second.count(col)		== 0)
+			{
+				rowMin = std::min(rowMin, row);
+				rowMax = std::max(rowMax, row);
+				colMin = std::min(colMin, col);
+				colMax = std::max(colMax, col);
+			}
+	}
+
+	if(rowMax != -1)
+	{
+		_blockSource->dataBlock(rowMin, rowMax, colMin, colMax, _block);
+
+		for(int row=rowMin; row<=rowMax; row++)
+		{
+			auto & flags	= _storedLineFlags[row];
+			auto & active	= _storedActive[row];
+			auto & text		= _storedDisplayText[row];
+
+			for(int col=colMin; col<=colMax; col++)
+			{
+				size_t cell = _block.index(row, col);
+
+				flags[col]	= _block.lines[cell];
+				active[col]	= _block.active[cell] != 0;
+				text[col]	= _block.text[cell];
+			}
+		}
+	}
+
+	JASPTIMER_STOP(fetchMissingCells);
+}
+
 void DataSetView::buildNewLinesAndCreateNewItems()
 {
 	JASPTIMER_RESUME(buildNewLinesAndCreateNewItems);
@@ -286,15 +539,20 @@ void DataSetView::buildNewLinesAndCreateNewItems()
 
 	//and now we should create some new ones!
 
+	fetchMissingCells();
+
 	float	maxXForVerticalLine	= _viewportX + _viewportW - extraColumnWidth(), //To avoid seeing lines through add computed column button
 			maxYForVerticalLine = _viewportY + _dataRowsMaxHeight;
 
 	JASPTIMER_RESUME(buildNewLinesAndCreateNewItems_GRID);
 
 	for(int col=_currentViewportColMin; col<_currentViewportColMax; col++)
+	{
+		float colX = colXPosition(col);
+
 		for(int row=_currentViewportRowMin; row<_currentViewportRowMax; row++)
 		{
-			float	pos0x(_colXPositions[col]),
+			float	pos0x(colX),
 					pos0y(_dataRowsMaxHeight + row * _dataRowsMaxHeight),
 					pos1x(pos0x + _dataColsMaxWidth[col]),
 					pos1y(pos0y + _dataRowsMaxHeight);
@@ -338,6 +596,7 @@ void DataSetView::buildNewLinesAndCreateNewItems()
 			}
 #endif
 		}
+	}
 
 	JASPTIMER_STOP(buildNewLinesAndCreateNewItems_GRID);
 
@@ -380,7 +639,7 @@ void DataSetView::buildNewLinesAndCreateNewItems()
 		createColumnHeader(col);
 
 #ifdef ADD_LINES_PLEASE
-		float	pos0x(_colXPositions[col]),
+		float	pos0x(colXPosition(col)),
 				pos0y(_viewportY),
 				pos1x(pos0x + _dataColsMaxWidth[col]),
 				pos1y(pos0y + _dataRowsMaxHeight);
@@ -421,8 +680,9 @@ QQuickItem * DataSetView::createTextItem(int row, int col)
 		QQuickItem			* textItem	= nullptr;
 		ItemContextualized	* itemCon	= nullptr;
 
-		QModelIndex ind(_model->index(row, col));
-		bool active = _model->data(ind, _roleNameToRole["active"]).toBool();
+		if(_storedActive.count(row) == 0 || _storedActive[row].count(col) == 0)
+			_storedActive[row][col] = _model->data(_model->index(row, col), _roleNameToRole["active"]).toBool();
+		bool active = _storedActive[row][col];
 
 		if(_textItemStorage.size() > 0)
 		{
@@ -468,7 +728,7 @@ QQuickItem * DataSetView::createTextItem(int row, int col)
 			textItem->setHeight(_dataRowsMaxHeight);
 			textItem->setWidth(_dataColsMaxWidth[col]);
 		}
-		textItem->setX(_colXPositions[col] + _itemHorizontalPadding);
+		textItem->setX(colXPosition(col) + _itemHorizontalPadding);
 		textItem->setY((isTextItem ? (-2 + _itemVerticalPadding) : 0) + (row + 1) * _dataRowsMaxHeight);
 		textItem->setZ(-4);
 		textItem->setVisible(true);
@@ -669,7 +929,7 @@ QQuickItem * DataSetView::createColumnHeader(int col)
 	else
 		columnHeader = _columnHeaderItems[col]->item;
 
-	columnHeader->setX(_colXPositions[col]);
+	columnHeader->setX(colXPosition(col));
 	columnHeader->setY(_viewportY);
 	columnHeader->setZ(-3);
 
@@ -12,6 +12,7 @@
 #include <QFontMetricsF>
 #include <QtQml>
 #include "utilities/qutils.h"
+#include "datasetviewblock.h"
 
 //#define DATASETVIEW_DEBUG_VIEWPORT
 //#define DATASETVIEW_DEBUG_CREATION
@@ -126,15 +127,16 @@ public slots:
 	void reloadColumnHeaders();
 
 
-	void modelDataChanged(const QModelIndex &, const QModelIndex &, const QVector<int> &)	{ calculateCellSizes(); }
-	void modelHeaderDataChanged(Qt::Orientation, int, int)									{ calculateCellSizes(); }
-	void modelAboutToBeReset()																{ _storedLineFlags.clear(); _storedDisplayText.clear(); }
+	void modelDataChanged(const QModelIndex & topLeft, const QModelIndex & bottomRight, const QVector<int> &);
+	void modelHeaderDataChanged(Qt::Orientation orientation, int first, int last);
+	void modelAboutToBeReset()																{ _storedLineFlags.clear(); _storedDisplayText.clear(); _storedActive.clear(); }
 	void modelWasReset()																	{ setRolenames(); calculateCellSizes(); }
 
 protected:
 	void setRolenames();
 	void determineCurrentViewPortIndices();
 	void storeOutOfViewItems();
+	void fetchMissingCells();
 	void buildNewLinesAndCreateNewItems();
 
 	QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
@@ -158,13 +160,27 @@ protected:
 
 	void addLine(float x0, float y0, float x1, float y1);
 
+	QStringList	maxColStrings(int colFirst, int colLast);
+
+	bool	layoutNeedsFullRecalculation() const;
+	void	forgetCells(int rowFirst, int rowLast, int colFirst, int colLast);
+	int		remeasureColumns(int colFirst, int colLast);
+	void	repositionItemsFrom(int colFirst);
+
+	void	rebuildColWidthTree();
+	void	colWidthTreeAdd(int col, float delta);
+	float	colXPosition(int col) const;
+	int		colAtX(float x) const;
+
 
 protected:
 	QAbstractTableModel *								_model = nullptr;
+	const DataSetViewBlockSource *						_blockSource = nullptr;
+	DataSetViewBlock									_block;
 
 	std::vector<QSizeF>									_cellSizes; //[col]
-	std::vector<float>									_colXPositions; //[col][row]
 	std::vector<float>									_dataColsMaxWidth;
+	std::vector<float>									_colWidthTree;			//Fenwick tree over _dataColsMaxWidth, [col + 1], so that x-positions can be updated and looked up in log-time
 	std::stack<ItemContextualized*>						_textItemStorage;
 	std::stack<ItemContextualized*>						_rowNumberStorage;
 	std::map<int, ItemContextualized *>					_rowNumberItems;
@@ -176,7 +192,8 @@ protected:
 														*_extraColumnItem = nullptr;
 
 	bool	_recalculateCellSizes	= false,
-			_ignoreViewpoint		= true;
+			_ignoreViewpoint		= true,
+			_modelHasMaxColStrings	= false;
 
 	float	_dataRowsMaxHeight,
 			_itemHorizontalPadding	= 8,
@@ -210,11 +227,13 @@ protected:
 	std::map<std::string, int> _roleNameToRole;
 
 	float	_rowNumberMaxWidth	= 0;
+	int		_laidOutRowCount	= 0;
 	bool	_linesWasChanged	= false;
 	size_t	_linesActualSize	= 0;
 
 	std::map<size_t, std::map<size_t, unsigned char>>	_storedLineFlags;
 	std::map<size_t, std::map<size_t, QString>>			_storedDisplayText;
+	std::map<size_t, std::map<size_t, bool>>			_storedActive;
 
 	static DataSetView * _lastInstancedDataSetView;
 };
@@ -0,0 +1,43 @@
+#ifndef DATASETVIEWBLOCK_H
+#define DATASETVIEWBLOCK_H
+
+#include <QString>
+#include <vector>
+
+///Everything DataSetView needs to show a rectangle of cells, stored column by column.
+struct DataSetViewBlock
+{
+	int							rowFirst	= 0,
+								colFirst	= 0,
+								rows		= 0,
+								cols		= 0;
+	std::vector<QString>		text;
+	std::vector<unsigned char>	lines,
+								active;
+
+	size_t index(int row, int col) const { return size_t(col - colFirst) * rows + (row - rowFirst); }
+
+	void resize(int newRowFirst, int rowLast, int newColFirst, int colLast)
+	{
+		rowFirst	= newRowFirst;
+		colFirst	= newColFirst;
+		rows		= rowLast - rowFirst + 1;
+		cols		= colLast - colFirst + 1;
+
+		size_t cells = size_t(rows) * cols;
+
+		text.assign(cells, QString());
+		lines.assign(cells, 0);
+		active.assign(cells, 0);
+	}
+};
+
+///A model used in a DataSetView can implement this to hand over a whole block of cells at once, instead of answering data() for every cell and every role.
+class DataSetViewBlockSource
+{
+public:
+	virtual			~DataSetViewBlockSource() {}
+	virtual void	dataBlock(int rowFirst, int rowLast, int colFirst, int colLast, DataSetViewBlock & block) const = 0;
+};
+
+#endif // DATASETVIEWBLOCK_H
@@ -2,6 +2,8 @@
 #include <QXmlStreamReader>
 #include <stack>
 #include <iostream>
+#include <sstream>
+#include <cmath>
 #include "log.h"
 
 namespace resultXmlCompare
@@ -9,6 +11,9 @@ namespace resultXmlCompare
 
 compareResults * compareResults::singleton = nullptr;
 
+const std::set<std::string>	compareResults::volatileKeys			= { "progress", "citation", "citations" }; //These change between runs or versions without the results being any different
+const size_t				compareResults::maxReportedDifferences	= 50;
+
 compareResults * compareResults::theOne()
 {
 	if(singleton == nullptr)
@@ -256,9 +261,104 @@ result compareResults::convertXmltoResultStruct(const QString &  resultXml)
 
 bool compareResults::compare()
 {
+	if(compareJson)
+		return compareJsonResults(originalResultsJson, refreshedResultsJson);
+
 	return compare(originalResultExport, refreshedResultExport);
 }
 
+Json::Value compareResults::resultsPerAnalysis(const Json::Value & analyses)
+{
+	const Json::Value	& list		= analyses.isObject() ? analyses["analyses"] : analyses; //Older jasp-files only have the array
+	Json::Value			  results	= Json::objectValue;
+
+	if(list.isArray())
+		for(const Json::Value & analysis : list)
+			results[std::to_string(analysis.get("id", -1).asInt())] = analysis.get("results", Json::nullValue);
+
+	return results;
+}
+
+bool compareResults::numbersEqual(double oldNumber, double newNumber) const
+{
+	if(std::isnan(oldNumber) || std::isnan(newNumber))
+		return std::isnan(oldNumber) && std::isnan(newNumber);
+
+	return oldNumber == newNumber || std::abs(oldNumber - newNumber) <= numericTolerance * std::max(std::abs(oldNumber), std::abs(newNumber));
+}
+
+void compareResults::diffJson(const Json::Value & oldValue, const Json::Value & newValue, const std::string & path, std::vector<std::string> & differences, size_t & differenceCount) const
+{
+	auto addDifference = [&](const std::string & what)
+	{
+		if(differenceCount++ < maxReportedDifferences)
+			differences.push_back(path + ": " + what);
+	};
+
+	auto shortValue = [](const Json::Value & value)
+	{
+		std::string written = Json::FastWriter().write(value);
+		written = written.substr(0, written.find_last_not_of('\n') + 1);
+		return written.size() > 60 ? written.substr(0, 57) + "..." : written;
+	};
+
+	if(oldValue.isNumeric() && newValue.isNumeric())
+	{
+		if(!numbersEqual(oldValue.asDouble(), newValue.asDouble()))
+			addDifference(shortValue(oldValue) + " became " + shortValue(newValue));
+	}
+	else if(oldValue.type() != newValue.type())
+		addDifference(shortValue(oldValue) + " became " + shortValue(newValue));
+	else if(oldValue.isObject())
+	{
+		for(const std::string & key : oldValue.getMemberNames())
+			if(volatileKeys.count(key) == 0 && !(key == "data" && oldValue[key].isString())) //The data of a plot is the name of its png, which changes every run
+			{
+				if(!newValue.isMember(key))	addDifference("\"" + key + "\" is missing");
+				else						diffJson(oldValue[key], newValue[key], path + "/" + key, differences, differenceCount);
+			}
+
+		for(const std::string & key : newValue.getMemberNames())
+			if(volatileKeys.count(key) == 0 && !oldValue.isMember(key))
+				addDifference("\"" + key + "\" is new");
+	}
+	else if(oldValue.isArray())
+	{
+		if(oldValue.size() != newValue.size())
+			addDifference("had " + std::to_string(oldValue.size()) + " elements but now " + std::to_string(newValue.size()));
+
+		for(Json::ArrayIndex i=0; i<std::min(oldValue.size(), newValue.size()); i++)
+			diffJson(oldValue[i], newValue[i], path + "/" + std::to_string(i), differences, differenceCount);
+	}
+	else if(oldValue != newValue)
+		addDifference(shortValue(oldValue) + " became " + shortValue(newValue));
+}
+
+bool compareResults::compareJsonResults(const Json::Value & resultsOld, const Json::Value & resultsNew)
+{
+	ranCompare = true;
+
+	std::vector<std::string>	differences;
+	size_t						differenceCount = 0;
+
+	diffJson(resultsOld, resultsNew, "analysis", differences, differenceCount);
+
+	succes = differenceCount == 0;
+
+	std::stringstream compareConclusion;
+	compareConclusion << "The results are " << (succes ? "the same!" : "different...") << "\n";
+
+	for(const std::string & difference : differences)
+		compareConclusion << difference << "\n";
+
+	if(differenceCount > differences.size())
+		compareConclusion << "And " << (differenceCount - differences.size()) << " more differences.\n";
+
+	std::cerr  << compareConclusion.str() << std::endl;
+	Log::log() << compareConclusion.str();
+	return succes;
+}
+
 bool compareResults::compare(const QString & resultOld, const QString & resultNew)
 {
 	ranCompare = true;
@@ -2,7 +2,10 @@
 #define COMPARERESULTS_H
 
 #include <QString>
+#include <set>
+#include <vector>
 #include "resultscomparetable.h"
+#include "jsonredirect.h"
 
 namespace resultXmlCompare
 {
@@ -20,6 +23,13 @@ public:
 	void	setOriginalResult(QString result);
 	void	setRefreshResult(QString result);
 
+	///Instead of the exported html the stored results-json of the analyses is compared, numbers are allowed to differ by tolerance (relative to their size)
+	void	enableJsonComparison(double tolerance)	{ compareJson = true; numericTolerance = tolerance; }
+	bool	jsonComparison()				const	{ return compareJson; }
+	void	setOriginalAnalyses(const Json::Value & analyses)	{ originalResultsJson	= resultsPerAnalysis(analyses); }
+	void	setRefreshAnalyses(const Json::Value & analyses)	{ refreshedResultsJson	= resultsPerAnalysis(analyses); }
+	bool	compareJsonResults(const Json::Value & resultsOld, const Json::Value & resultsNew);
+
 	void	enableTestMode()			{ runningTestMode = true; }
 	bool	testMode()			const	{ return runningTestMode; }
 
@@ -43,10 +53,15 @@ public:
 private:
 	explicit		compareResults() {}
 
+	static	Json::Value	resultsPerAnalysis(const Json::Value & analyses);
+			bool		numbersEqual(double oldNumber, double newNumber) const;
+			void		diffJson(const Json::Value & oldValue, const Json::Value & newValue, const std::string & path, std::vector<std::string> & differences, size_t & differenceCount) const;
+
 	bool			runningTestMode				= false,
 					atLeastOneRefreshHappened	= false,
 					resultsExportCalled			= false,
 					saveAfterRefresh			= false,
+					compareJson					= false,
 					ranCompare					= false,
 					succes						= false;
 
@@ -54,6 +69,13 @@ private:
 					refreshedResultExport		= "",
 					_filePath					= "";
 
+	double			numericTolerance			= 0;
+	Json::Value		originalResultsJson,
+					refreshedResultsJson;
+
+	static const std::set<std::string>	volatileKeys;
+	static const size_t					maxReportedDifferences;
+
 	static compareResults*	singleton;
 };
 
@@ -31,6 +31,7 @@
 #include "tempfiles.h"
 #include <functional>
 #include "timers.h"
+#include "tracer.h"
 #include "utilities/settings.h"
 #include <QMimeData>
 #include <QAction>
@@ -61,6 +62,8 @@ void ResultsJsInterface::setZoomInWebEngine()
 
 void ResultsJsInterface::resultsPageLoaded(bool succes)
 {
+	_analysesInResults.clear(); //A freshly loaded page knows nothing yet
+
 	if (succes)
 	{
 		QString version = AboutModel::getJaspVersion();
@@ -104,6 +107,7 @@ void ResultsJsInterface::setGlobalJsValues()
 	QString js = "window.globSet.pExact = " + exactPValueString;
 	js += "; window.globSet.decimals = " + (numDecimals.isEmpty() ? "\"\"" : numDecimals);
 	js += "; window.globSet.tempFolder = \"" + tempFolder + "/\"";
+	js += "; window.globSet.tablePageSize = " + Settings::value(Settings::RESULTS_TABLE_PAGE_SIZE).toString();
 	emit runJavaScript(js);
 }
 
@@ -122,6 +126,11 @@ void ResultsJsInterface::saveTempImage(int id, QString path, QByteArray data)
 	emit runJavaScript(eval);
 }
 
+void ResultsJsInterface::analysisImageRewrittenHandler(Analysis *analysis, QString plotName)
+{
+	emit runJavaScript("window.refreshRewrittenImage(" + QString::number(analysis->id()) + ", '" + escapeJavascriptString(plotName) + "');");
+}
+
 void ResultsJsInterface::analysisImageEditedHandler(Analysis *analysis)
 {
 	Json::Value imgJson = analysis->getImgResults();
@@ -229,12 +238,71 @@ void ResultsJsInterface::exportSelected(const QString &filename)
 
 void ResultsJsInterface::analysisChanged(Analysis *analysis)
 {
+	JASPTRACE_SCOPE(ResultsJsInterface::analysisChanged);
+
 	Json::Value analysisJson	= analysis->asJSON();
 	analysisJson["userdata"]	= analysis->userData();
-	QString results				= tq(analysisJson.toStyledString());
-	results						= "window.analysisChanged(JSON.parse('" + escapeJavascriptString(results) + "'));";
 
-	emit runJavaScript(results);
+	//Compact JSON is a javascript literal as well, so it needs no escaping or styling, except for the two line separators javascript doesn't allow in strings.
+	//It goes through runJavaScript like everything else, so it can't overtake or trail a select, remove or title change and it can't get lost before the webchannel is up.
+	QString patch = tq(Json::FastWriter().write(analysisPatch(analysisJson)));
+	patch.replace(QChar(0x2028), "\\u2028").replace(QChar(0x2029), "\\u2029");
+
+	emit runJavaScript("window.analysisPatched(" % patch % ");");
+}
+
+Json::Value ResultsJsInterface::analysisPatch(const Json::Value &analysisJson)
+{
+	int			id		= analysisJson["id"].asInt();
+	Json::Value	patch	= Json::objectValue;
+	auto		prevIt	= _analysesInResults.find(id);
+
+	if(prevIt == _analysesInResults.end())
+	{
+		patch["full"]		= true;
+		patch["analysis"]	= analysisJson;
+	}
+	else
+	{
+		const Json::Value	& prev			= prevIt->second,
+							& results		= analysisJson["results"],
+							& prevResults	= prev["results"];
+
+		Json::Value	changed			= Json::objectValue,
+					changedResults	= Json::objectValue,
+					removedResults	= Json::arrayValue;
+
+		for(const std::string & key : analysisJson.getMemberNames())
+			if(key != "results" && (!prev.isMember(key) || prev[key] != analysisJson[key]))
+				changed[key] = analysisJson[key];
+
+		if(!results.isObject() || !prevResults.isObject())
+		{
+			if(results != prevResults)
+				changed["results"] = results;
+		}
+		else
+		{
+			//Only the top-level result nodes (tables, plots, containers) are diffed, the results page replaces those as a whole.
+			for(const std::string & name : results.getMemberNames())
+				if(!prevResults.isMember(name) || prevResults[name] != results[name])
+					changedResults[name] = results[name];
+
+			for(const std::string & name : prevResults.getMemberNames())
+				if(!results.isMember(name))
+					removedResults.append(name);
+		}
+
+		patch["full"]			= false;
+		patch["id"]				= id;
+		patch["analysis"]		= changed;
+		patch["results"]		= changedResults;
+		patch["removed"]		= removedResults;
+	}
+
+	_analysesInResults[id] = analysisJson;
+
+	return patch;
 }
 
 void ResultsJsInterface::setResultsMeta(QString str)
@@ -246,6 +314,7 @@ void ResultsJsInterface::setResultsMeta(QString str)
 
 void ResultsJsInterface::resetResults()
 {
+	_analysesInResults.clear();
 	emit resultsPageUrlChanged(_resultsPageUrl);
 }
 
@@ -256,11 +325,13 @@ void ResultsJsInterface::unselect()
 
 void ResultsJsInterface::removeAnalysis(Analysis *analysis)
 {
+	_analysesInResults.erase(analysis->id());
 	emit runJavaScript("window.remove(" % QString::number(analysis->id()) % ")");
 }
 
 void ResultsJsInterface::removeAnalyses()
 {
+	_analysesInResults.clear();
 	emit runJavaScript("window.removeAllAnalyses()");
 }
 
@@ -71,6 +71,7 @@ signals:
 	Q_INVOKABLE void packageModified();
 	Q_INVOKABLE void refreshAllAnalyses();
 	Q_INVOKABLE void removeAllAnalyses();
+	Q_INVOKABLE void visiblePlotsChanged(QStringList plotNames);
 
 public slots:
 	void setZoom(double zoom);
@@ -101,6 +102,7 @@ public slots:
 	void setExactPValuesHandler(bool exact);
 	void setFixDecimalsHandler(QString numDecimals);
 	void analysisImageEditedHandler(Analysis *analysis);
+	void analysisImageRewrittenHandler(Analysis *analysis, QString plotName);
 	void cancelImageEdit(int id);
 	void exportSelected(const QString &filename);
 	void setResultsPageUrl(QString resultsPageUrl);
@@ -110,6 +112,7 @@ public slots:
 private:
 	void setGlobalJsValues();
 	QString escapeJavascriptString(const QString &str);
+	Json::Value analysisPatch(const Json::Value &analysisJson);
 
 private slots:
 	void menuHidding();
@@ -119,6 +122,8 @@ private:
 	Json::Value		_resultsMeta;
 	QVariant		_allUserData;
 	QString			_resultsPageUrl = "qrc:///core/index.html";
+
+	std::map<int, Json::Value>	_analysesInResults; //What the results page last got from us, so we only need to push what changed since then
 };
 
 
@@ -32,7 +32,11 @@ const Settings::Setting Settings::Values[] = {
 	{"logFilesMax",					50},
 	{"maxFlickVelocity",			800},
 	{"modulesRemember",				true},
-	{"modulesRemembered",			""}
+	{"modulesRemembered",			""},
+	{"resultsTablePageSize",		1000}, //Tables with more rows than this are shown one page of this many rows at a time
+	{"traceToFile",					false},
+	{"engineZygote",				false}, //Only on linux: fork the engines from a single initialized one, opt-in until it has proven itself
+	{"dataInMappedFile",			false} //Keep the data in a memory-mapped file in the temp directory instead of in shared memory, for data sets larger than memory
 };
 
 QVariant Settings::value(Settings::Type key)
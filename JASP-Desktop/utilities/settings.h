@@ -35,7 +35,11 @@ public:
 		LOG_FILES_MAX,
 		QML_MAX_FLICK_VELOCITY,
 		MODULES_REMEMBER,
-		MODULES_REMEMBERED
+		MODULES_REMEMBERED,
+		RESULTS_TABLE_PAGE_SIZE,
+		TRACE_TO_FILE,
+		ENGINE_ZYGOTE,
+		DATA_IN_MAPPED_FILE
 	};
 
 	static QVariant value(Settings::Type key);
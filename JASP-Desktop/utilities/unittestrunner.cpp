@@ -0,0 +1,160 @@
+#include "unittestrunner.h"
+
+#include <QDir>
+#include <QFile>
+#include <iostream>
+#include <algorithm>
+#include "jsonredirect.h"
+
+UnitTestRunner::UnitTestRunner(const QString & program, int timeOut, bool save, bool hideJASP, int jobs, int shard, int shardCount, const QStringList & extraArguments)
+	: _program(program), _timeOut(timeOut), _jobs(std::max(1, jobs)), _shard(shard), _shardCount(std::max(1, shardCount)), _save(save), _hideJASP(hideJASP), _extraArguments(extraArguments)
+{}
+
+void UnitTestRunner::collectFiles(const QFileInfo & file)
+{
+	const QString jaspExtension(".jasp");
+
+	if(file.isDir())
+	{
+		QDir dir(file.absoluteFilePath());
+
+		for(const QFileInfo & subFile : dir.entryInfoList(QDir::Filter::NoDotAndDotDot | QDir::Files | QDir::Dirs, QDir::Name))
+			collectFiles(subFile);
+	}
+	else if(file.isFile() && file.absoluteFilePath().endsWith(jaspExtension))
+		_files << file.absoluteFilePath();
+}
+
+void UnitTestRunner::run()
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	//Every shard takes every _shardCount-th file of the sorted list, that way slow folders get spread over the shards as well
+	_results.clear();
+	for(int i = _shard; i < _files.size(); i += _shardCount)
+	{
+		Result result;
+		result.file = _files[i];
+		_results.push_back(result);
+	}
+
+	std::vector<Job*>	running;
+	size_t				next = 0;
+
+	while(next < _results.size() || running.size() > 0)
+	{
+		while(running.size() < size_t(_jobs) && next < _results.size())
+			running.push_back(startJob(next++));
+
+		for(auto it = running.begin(); it != running.end();)
+		{
+			Job * job		= *it;
+			bool finished	= job->process.waitForFinished(50) || job->process.state() == QProcess::NotRunning;
+
+			job->errorOutput += job->process.readAllStandardError();
+			job->process.readAllStandardOutput(); //Nobody looks at it, but it shouldn't pile up either
+
+			bool timedOut	= !finished && job->timer.elapsed() > (_timeOut * 60000) + 10000;
+
+			if(!finished && !timedOut)
+			{
+				it++;
+				continue;
+			}
+
+			if(timedOut)
+			{
+				job->process.kill();
+				job->process.waitForFinished(1000);
+			}
+
+			finishJob(job, timedOut);
+			delete job;
+			it = running.erase(it);
+		}
+	}
+
+	_seconds = timer.elapsed() / 1000.0;
+}
+
+UnitTestRunner::Job * UnitTestRunner::startJob(size_t fileIndex)
+{
+	Job * job		= new Job();
+	job->fileIndex	= fileIndex;
+
+	QStringList arguments({"--unitTest", _results[fileIndex].file});
+
+	if(_save)
+		arguments << "--save";
+
+	arguments << QString::fromStdString("--timeOut="+std::to_string(_timeOut)) << _extraArguments;
+
+#ifdef __linux__
+	arguments << "--engineZygote"; //Forking the engines from an initialized one saves every file the time R takes to start
+#endif
+
+	if(_hideJASP)
+		arguments << "-platform" << "minimal";
+
+	std::cout << "Starting subJASP with args: " << arguments.join(' ').toStdString() << std::endl;
+
+	job->process.setProgram(_program);
+	job->process.setArguments(arguments);
+	job->process.start();
+	job->timer.start();
+
+	return job;
+}
+
+void UnitTestRunner::finishJob(Job * job, bool timedOut)
+{
+	Result & result	= _results[job->fileIndex];
+	result.seconds	= job->timer.elapsed() / 1000.0;
+	result.exitCode	= timedOut || job->process.exitStatus() == QProcess::CrashExit ? -1 : job->process.exitCode();
+	result.outcome	= timedOut ? "timedOut" : job->process.exitStatus() == QProcess::CrashExit ? "crashed" : result.exitCode == 0 ? "succeeded" : "failed";
+
+	std::cerr << job->errorOutput.toStdString() << std::endl;
+	std::cout << "JASP file " << result.file.toStdString() << (result.exitCode == 0 ? " succeeded" : " failed") << " (" << result.outcome << " after " << result.seconds << "s)!" << std::endl;
+}
+
+size_t UnitTestRunner::failures() const
+{
+	return std::count_if(_results.begin(), _results.end(), [](const Result & result) { return result.exitCode != 0; });
+}
+
+bool UnitTestRunner::writeReport(const QString & reportPath) const
+{
+	Json::Value report(Json::objectValue);
+
+	report["shard"]		= _shard + 1;
+	report["shards"]	= _shardCount;
+	report["jobs"]		= _jobs;
+	report["total"]		= int(total());
+	report["failures"]	= int(failures());
+	report["seconds"]	= _seconds;
+	report["files"]		= Json::arrayValue;
+
+	for(const Result & result : _results)
+	{
+		Json::Value entry(Json::objectValue);
+
+		entry["file"]		= result.file.toStdString();
+		entry["result"]		= result.outcome;
+		entry["exitCode"]	= result.exitCode;
+		entry["seconds"]	= result.seconds;
+
+		report["files"].append(entry);
+	}
+
+	QFile reportFile(reportPath);
+
+	if(!reportFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		std::cerr << "Could not write unit test report to " << reportPath.toStdString() << std::endl;
+		return false;
+	}
+
+	reportFile.write(report.toStyledString().c_str());
+	return true;
+}
@@ -0,0 +1,58 @@
+#ifndef UNITTESTRUNNER_H
+#define UNITTESTRUNNER_H
+
+#include <QFileInfo>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <vector>
+#include <string>
+
+///Runs --unitTest on every .jasp file in a folder, each in a separate JASP process and several of them at the same time.
+///The list of files can be split in shards, so that multiple invocations (on multiple machines for instance) can each take a part of it.
+class UnitTestRunner
+{
+public:
+	UnitTestRunner(const QString & program, int timeOut, bool save, bool hideJASP, int jobs = 1, int shard = 0, int shardCount = 1, const QStringList & extraArguments = {});
+
+	void	collectFiles(const QFileInfo & file);
+	void	run();
+	bool	writeReport(const QString & reportPath) const;
+
+	size_t	total()		const { return _results.size(); }
+	size_t	failures()	const;
+
+private:
+	struct Job
+	{
+		size_t			fileIndex;
+		QProcess		process;
+		QElapsedTimer	timer;
+		QByteArray		errorOutput;
+	};
+
+	struct Result
+	{
+		QString		file;
+		std::string	outcome		= "notRun";
+		int			exitCode	= -1;
+		double		seconds		= 0;
+	};
+
+	Job		*	startJob(size_t fileIndex);
+	void		finishJob(Job * job, bool timedOut);
+
+	QString				_program;
+	int					_timeOut,
+						_jobs,
+						_shard,
+						_shardCount;
+	bool				_save,
+						_hideJASP;
+	QStringList			_files,
+						_extraArguments; ///< Passed on to every sub-JASP
+	std::vector<Result>	_results;
+	double				_seconds = 0;
+};
+
+#endif // UNITTESTRUNNER_H
@@ -138,6 +138,8 @@ void LevelsTableModel::_moveRows(QModelIndexList &selection, bool up) {
 		//}
 	}
 
+	_preserveColumn();
+
 	beginResetModel();
 	labels.set(new_labels);
 	endResetModel();
@@ -156,6 +158,7 @@ void LevelsTableModel::reverse() {
     if (_column == NULL)
         return;
 
+	_preserveColumn();
 	beginResetModel();
 
     Labels &labels = _column->labels();
@@ -190,6 +193,7 @@ bool LevelsTableModel::setData(const QModelIndex & index, const QVariant & value
     {
         const std::string &new_label = value.toString().toStdString();
         if (new_label != "") {
+			_preserveColumn();
             Labels &labels = _column->labels();
 			if (labels.setLabelFromRow(index.row(), new_label))
 			{
@@ -241,6 +245,8 @@ int LevelsTableModel::currentColumnIndex()
 
 void LevelsTableModel::resetFilterAllows()
 {
+	_preserveColumn();
+
 	beginResetModel();
 	_column->resetFilter();
 	endResetModel();
@@ -264,6 +270,8 @@ bool LevelsTableModel::setAllowFilterOnLabel(int row, bool newAllowValue)
 
 	if(atLeastOneRemains)
 	{
+		_preserveColumn();
+
 		bool before = _column->hasFilter();
 		_column->labels()[row].setFilterAllows(newAllowValue);
 		if(before != _column->hasFilter())
@@ -80,6 +80,7 @@ private:
 	int			_chosenColumn	= -1;
 
 	void _moveRows(QModelIndexList &selection, bool up = true);
+	void _preserveColumn()	{ if (_dataSet != NULL && _column != NULL) _dataSet->preserveForSnapshots(*_column); } ///< Running analyses keep seeing the labels as they were
 	int currentColumnIndex();
 
 };
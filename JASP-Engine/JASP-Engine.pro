@@ -108,6 +108,11 @@ HEADERS += \
     rbridge.h \
     r_functionwhitelist.h
 
+linux {
+    SOURCES += zygote.cpp
+    HEADERS += zygote.h
+}
+
 DISTFILES += \
     JASP/DESCRIPTION \
     JASP/NAMESPACE \
@@ -29,6 +29,7 @@
 
 #include "rbridge.h"
 #include "timers.h"
+#include "tracer.h"
 #include "log.h"
 
 void SendFunctionForJaspresults(const char * msg) { Engine::theEngine()->sendString(msg); }
@@ -69,12 +70,13 @@ Engine::Engine(int slaveNo, unsigned long parentPID)
 	rbridge_setStateFileSource(			boost::bind(&Engine::provideStateFileName,			this, _1, _2));
 	rbridge_setJaspResultsFileSource(	boost::bind(&Engine::provideJaspResultsFileName,	this, _1, _2));
 
-	rbridge_setColumnDataAsScaleSource(			boost::bind(&Engine::setColumnDataAsScale,			this, _1, _2));
-	rbridge_setColumnDataAsOrdinalSource(		boost::bind(&Engine::setColumnDataAsOrdinal,		this, _1, _2, _3));
-	rbridge_setColumnDataAsNominalSource(		boost::bind(&Engine::setColumnDataAsNominal,		this, _1, _2, _3));
-	rbridge_setColumnDataAsNominalTextSource(	boost::bind(&Engine::setColumnDataAsNominalText,	this, _1, _2));
+	rbridge_setColumnDataAsScaleSource(			boost::bind(&Engine::setColumnDataAsScale,			this, _1, _2, _3));
+	rbridge_setColumnDataAsOrdinalSource(		boost::bind(&Engine::setColumnDataAsOrdinal,		this, _1, _2, _3, _4));
+	rbridge_setColumnDataAsNominalSource(		boost::bind(&Engine::setColumnDataAsNominal,		this, _1, _2, _3, _4));
+	rbridge_setColumnDataAsNominalTextSource(	boost::bind(&Engine::setColumnDataAsNominalText,	this, _1, _2, _3, _4));
 
 	rbridge_setGetDataSetRowCountSource( boost::bind(&Engine::dataSetRowCount, this));
+	rbridge_setSnapshotVersion(0, _slaveNo);
 
 	JASPTIMER_STOP(Engine Constructor);
 
@@ -93,6 +95,12 @@ Engine::~Engine()
 	_channel = nullptr;
 }
 
+void Engine::setSlaveNo(int no)
+{
+	_slaveNo = no; //Only changes after construction when forked from the zygote
+	rbridge_setSnapshotVersion(_pinnedSnapshot, _slaveNo);
+}
+
 void Engine::run()
 {
 	JASPTIMER_START(Engine::run startup);
@@ -185,6 +193,8 @@ void Engine::receiveFilterMessage(const Json::Value & jsonRequest)
 
 void Engine::runFilter(const std::string & filter, const std::string & generatedFilter, int filterRequestId)
 {
+	JASPTRACE_SCOPE(Engine::runFilter);
+
 	try
 	{
         std::string strippedFilter		= stringUtils::stripRComments(filter);
@@ -297,6 +307,7 @@ void Engine::receiveComputeColumnMessage(const Json::Value & jsonRequest)
 void Engine::runComputeColumn(const std::string & computeColumnName, const std::string & computeColumnCode, Column::ColumnType computeColumnType)
 {
 	Log::log() << "Engine::runComputeColumn()" << std::endl;
+	JASPTRACE_SCOPE(Engine::runComputeColumn);
 
 	static const std::map<Column::ColumnType, std::string> setColumnFunction = {
 		{Column::ColumnTypeScale,		".setColumnDataAsScale"},
@@ -406,6 +417,7 @@ void Engine::receiveAnalysisMessage(const Json::Value & jsonRequest)
 void Engine::runAnalysis()
 {
 	Log::log() << "Engine::runAnalysis()" << std::endl;
+	JASPTRACE_SCOPE(Engine::runAnalysis);
 
 	if(_analysisStatus == Status::saveImg)		{ saveImage();		return; }
 	if(_analysisStatus == Status::editImg)		{ editImage();		return; }
@@ -427,10 +439,14 @@ void Engine::runAnalysis()
 
 	_currentAnalysisKnowsAboutChange	= false;
 
+	pinDataSnapshot();
+
 	_analysisResultsString = _dynamicModuleCall != "" ?
 			rbridge_runModuleCall(_analysisName, _analysisTitle, _dynamicModuleCall, _analysisDataKey, _analysisOptions, _analysisStateKey, perform, _ppi, _analysisId, _analysisRevision, _imageBackground)
 		:	rbridge_run(_analysisName, _analysisTitle, _analysisRFile, _analysisRequiresInit, _analysisDataKey, _analysisOptions, _analysisResultsMeta, _analysisStateKey, _analysisId, _analysisRevision, perform, _ppi, _imageBackground, callback, _analysisJaspResults);
 
+	unpinDataSnapshot();
+
 	if (_analysisStatus == Status::initing || _analysisStatus == Status::running)  // if status hasn't changed
 		receiveMessages();
 
@@ -509,11 +525,17 @@ void Engine::editImage()
 
 void Engine::rewriteImages()
 {
-	jaspRCPP_rewriteImages(_ppi, _imageBackground.c_str());
+	//An empty name rewrites all plots of the analysis, otherwise only the one the desktop asked for
+	std::string name = _imageOptions.get("plot", "").asString();
+
+	jaspRCPP_rewriteImages(name.c_str(), _ppi, _imageBackground.c_str());
 
 	_analysisStatus				= Status::complete;
 	_analysisResults			= Json::Value();
 	_analysisResults["status"]	= analysisResultStatusToString(analysisResultStatus::imagesRewritten);
+
+	if(name != "")
+		_analysisResults["results"]["plot"] = name;
 	_progress					= -1;
 	sendAnalysisResults();
 
@@ -585,6 +607,37 @@ DataSet * Engine::provideDataSet()
 	return SharedMemory::retrieveDataSet(_parentPID);
 }
 
+///Makes the analysis read the data as it is now, while the desktop is free to change it in the meantime.
+void Engine::pinDataSnapshot()
+{
+	try
+	{
+		DataSet * dataSet = provideDataSet();
+
+		if (dataSet != NULL)
+			_pinnedSnapshot = dataSet->pinSnapshot(_slaveNo);
+	}
+	catch (std::exception & e) { Log::log() << "Engine::pinDataSnapshot could not get to the data: " << e.what() << std::endl; }
+
+	rbridge_setSnapshotVersion(_pinnedSnapshot, _slaveNo);
+}
+
+void Engine::unpinDataSnapshot()
+{
+	if (_pinnedSnapshot != 0)
+		try
+		{
+			DataSet * dataSet = provideDataSet();
+
+			if (dataSet != NULL)
+				dataSet->unpinSnapshot(_slaveNo);
+		}
+		catch (std::exception & e) { Log::log() << "Engine::unpinDataSnapshot could not get to the data: " << e.what() << std::endl; }
+
+	_pinnedSnapshot = 0;
+	rbridge_setSnapshotVersion(0, _slaveNo);
+}
+
 void Engine::provideStateFileName(std::string &root, std::string &relativePath)
 {
 	return TempFiles::createSpecific("state", _analysisId, root, relativePath);
@@ -660,7 +713,7 @@ bool Engine::isColumnNameOk(std::string columnName)
 	}
 }
 
-bool Engine::setColumnDataAsNominalOrOrdinal(bool isOrdinal, const std::string & columnName, std::vector<int> & data, const std::map<int, std::string> & levels)
+bool Engine::setColumnDataAsNominalOrOrdinal(bool isOrdinal, const std::string & columnName, const int * data, size_t length, const std::map<int, std::string> & levels)
 {
 	std::map<int, int> uniqueInts;
 
@@ -679,20 +732,34 @@ bool Engine::setColumnDataAsNominalOrOrdinal(bool isOrdinal, const std::string &
 
 	if(uniqueInts.size() == levels.size()) //everything was an int!
 	{
-		for(auto & dat : data)
+		//data belongs to R, so the values go through a copy here
+		std::vector<int> values(data, data + length);
+
+		for(auto & dat : values)
 			if(dat != INT_MIN)
 				dat = uniqueInts[dat];
 
-		if(isOrdinal)	return	provideDataSet()->columns()[columnName].overwriteDataWithOrdinal(data);
-		else			return	provideDataSet()->columns()[columnName].overwriteDataWithNominal(data);
+		if(isOrdinal)	return	columnToOverwrite(columnName).overwriteDataWithOrdinal(values.data(), values.size());
+		else			return	columnToOverwrite(columnName).overwriteDataWithNominal(values.data(), values.size());
 	}
 	else
 	{
-		if(isOrdinal)	return	provideDataSet()->columns()[columnName].overwriteDataWithOrdinal(data, levels);
-		else			return	provideDataSet()->columns()[columnName].overwriteDataWithNominal(data, levels);
+		if(isOrdinal)	return	columnToOverwrite(columnName).overwriteDataWithOrdinal(data, length, levels);
+		else			return	columnToOverwrite(columnName).overwriteDataWithNominal(data, length, levels);
 	}
 }
 
+///Analyses running on the other engines keep seeing the column as it was before this engine computed it again.
+Column & Engine::columnToOverwrite(const std::string & columnName)
+{
+	DataSet	*	dataSet	= provideDataSet();
+	Column	&	column	= dataSet->columns()[columnName];
+
+	dataSet->preserveForSnapshots(column, SharedMemory::segment(), _slaveNo);
+
+	return column;
+}
+
 void Engine::stopEngine()
 {
 	Log::log() << "Engine::stopEngine() received, closing engine." << std::endl;
@@ -707,6 +774,7 @@ void Engine::stopEngine()
 
 	_engineState = engineState::stopped;
 
+	unpinDataSnapshot();
 	freeRBridgeColumns();
 	SharedMemory::unloadDataSet();
 	sendEngineStopped();
@@ -731,6 +799,7 @@ void Engine::pauseEngine()
 
 	_engineState = engineState::paused;
 
+	unpinDataSnapshot();
 	freeRBridgeColumns();
 	SharedMemory::unloadDataSet();
 	sendEnginePaused();
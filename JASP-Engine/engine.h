@@ -45,14 +45,15 @@ public:
 	analysisResultStatus getStatusToAnalysisStatus();
 
 	//return true if changed:
-	bool setColumnDataAsScale(		const std::string & columnName, const	std::vector<double>			& scalarData)												{	if(!isColumnNameOk(columnName)) return false; return provideDataSet()->columns()[columnName].overwriteDataWithScale(scalarData);				}
-	bool setColumnDataAsOrdinal(	const std::string & columnName,			std::vector<int>			& ordinalData, const std::map<int, std::string> & levels)	{	if(!isColumnNameOk(columnName)) return false; return setColumnDataAsNominalOrOrdinal(true,  columnName, ordinalData, levels);					}
-	bool setColumnDataAsNominal(	const std::string & columnName,			std::vector<int>			& nominalData, const std::map<int, std::string> & levels)	{	if(!isColumnNameOk(columnName)) return false; return setColumnDataAsNominalOrOrdinal(false, columnName, nominalData, levels);					}
-	bool setColumnDataAsNominalText(const std::string & columnName, const	std::vector<std::string>	& nominalData)												{	if(!isColumnNameOk(columnName)) return false; return provideDataSet()->columns()[columnName].overwriteDataWithNominal(nominalData);			}
+	bool setColumnDataAsScale(		const std::string & columnName, const double	* scalarData,	size_t length)														{	if(!isColumnNameOk(columnName)) return false; return columnToOverwrite(columnName).overwriteDataWithScale(scalarData, length);						}
+	bool setColumnDataAsOrdinal(	const std::string & columnName, const int		* ordinalData,	size_t length, const std::map<int, std::string> & levels)			{	if(!isColumnNameOk(columnName)) return false; return setColumnDataAsNominalOrOrdinal(true,  columnName, ordinalData, length, levels);					}
+	bool setColumnDataAsNominal(	const std::string & columnName, const int		* nominalData,	size_t length, const std::map<int, std::string> & levels)			{	if(!isColumnNameOk(columnName)) return false; return setColumnDataAsNominalOrOrdinal(false, columnName, nominalData, length, levels);					}
+	bool setColumnDataAsNominalText(const std::string & columnName, const int		* codes,		size_t length, const std::vector<std::string> & distinctValues)	{	if(!isColumnNameOk(columnName)) return false; return columnToOverwrite(columnName).overwriteDataWithNominal(codes, length, distinctValues);			}
 
 	bool isColumnNameOk(std::string columnName);
 
-	bool setColumnDataAsNominalOrOrdinal(bool isOrdinal, const std::string & columnName, std::vector<int> & data, const std::map<int, std::string> & levels);
+	bool setColumnDataAsNominalOrOrdinal(bool isOrdinal, const std::string & columnName, const int * data, size_t length, const std::map<int, std::string> & levels);
+	Column & columnToOverwrite(const std::string & columnName);
 
 	int dataSetRowCount()	{ return static_cast<int>(provideDataSet()->rowCount()); }
 
@@ -94,6 +95,8 @@ private: // Methods:
 	std::string callback(const std::string &results, int progress);
 
 	DataSet *provideDataSet();
+	void	pinDataSnapshot();
+	void	unpinDataSnapshot();
 
 	void provideTempFileName(		const std::string &extension,	std::string &root,			std::string &relativePath);
 	void provideStateFileName(		std::string &root,				std::string &relativePath);
@@ -110,6 +113,8 @@ private: // Data:
 				_ppi = 96,
 				_slaveNo = 0;
 
+	size_t		_pinnedSnapshot = 0; ///< The version of the data the running analysis reads, 0 when nothing is pinned
+
 	bool		_analysisRequiresInit,
 				_analysisJaspResults,
 				_currentAnalysisKnowsAboutChange;
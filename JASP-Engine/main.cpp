@@ -17,7 +17,12 @@
 
 #include "engine.h"
 #include "timers.h"
+#include "tracer.h"
 #include "log.h"
+#ifdef __linux__
+#include "zygote.h"
+#include "processinfo.h"
+#endif
 
 #ifdef _WIN32
 void openConsoleOutput(unsigned long slaveNo, unsigned parentPID)
@@ -40,8 +45,59 @@ void openConsoleOutput(unsigned long slaveNo, unsigned parentPID)
 }
 #endif
 
+static void initLogs(const std::string & logFileBase, const std::string & logFileWhere, const std::string & engineName)
+{
+	Log::logFileNameBase = logFileBase;
+	Log::setLogFileName(logFileBase + " " + engineName + ".log");
+	Log::setWhere(logTypeFromString(logFileWhere));
+	Tracer::setOutputFile(logFileBase + " " + engineName + ".trace.json");
+}
+
+static int runEngine(Engine & e, unsigned long slaveNo, unsigned long parentPID)
+{
+	e.run();
+
+	JASPTIMER_PRINTALL();
+	Tracer::setEnabled(false); //Writes the trace if it was still running
+
+	Log::log() << "jaspEngine " << slaveNo << " child of " << parentPID << " stops." << std::endl;
+	return 0;
+}
+
 int main(int argc, char *argv[])
 {
+#ifdef __linux__
+	if(argc > 5 && std::string(argv[1]) == "zygote")
+	{
+		unsigned long	parentPID		= strtoul(argv[2], NULL, 10);
+		std::string		logFileBase		= argv[3],
+						logFileWhere	= argv[4],
+						socketPath		= argv[5];
+
+		Log::initRedirects();
+		initLogs(logFileBase, logFileWhere, "Engine zygote");
+
+		Log::log() << "jaspEngine started as zygote and it's parent PID is " << parentPID << std::endl;
+
+		Engine	e(0, parentPID); //Initializes R, which is what every forked engine gets for free
+		int		slaveNo;
+
+		if(!Zygote::forkEngines(socketPath, slaveNo))
+		{
+			Log::log() << "jaspEngine zygote child of " << parentPID << " stops." << std::endl;
+			return 0;
+		}
+
+		ProcessInfo::watchAsParent(parentPID); //So it keeps running when the zygote stops
+
+		initLogs(logFileBase, logFileWhere, "Engine " + std::to_string(slaveNo));
+		Log::log() << "jaspEngine forked from zygote and has slaveNo " << slaveNo << std::endl;
+
+		e.setSlaveNo(slaveNo);
+		return runEngine(e, slaveNo, parentPID);
+	}
+#endif
+
 	if(argc > 4)
 	{
 		unsigned long	slaveNo			= strtoul(argv[1], NULL, 10),
@@ -53,10 +109,8 @@ int main(int argc, char *argv[])
 		//openConsoleOutput(slaveNo, parentPID); //uncomment to have a console window open per Engine that shows you std out and cerr. (On windows only, on unixes you can just run JASP from a terminal)
 #endif
 
-		Log::logFileNameBase = logFileBase;
 		Log::initRedirects();
-		Log::setLogFileName(logFileBase + " Engine " + std::to_string(slaveNo) + ".log");
-		Log::setWhere(logTypeFromString(logFileWhere));
+		initLogs(logFileBase, logFileWhere, "Engine " + std::to_string(slaveNo));
 
 		Log::log() << "Log and possible redirects initialized!" << std::endl;
 
@@ -66,12 +120,8 @@ int main(int argc, char *argv[])
 
 		JASPTIMER_START(Engine Starting);
 		Engine e(slaveNo, parentPID);
-		e.run();
-
-		JASPTIMER_PRINTALL();
 
-		Log::log() << "jaspEngine " << slaveNo << " child of " << parentPID << " stops." << std::endl;
-		return 0;
+		return runEngine(e, slaveNo, parentPID);
 	}
 
 	Log::log() << "jaspEngine does not have all required information to run, it needs slaveNo as first argument and parent PID as second!" << std::endl;
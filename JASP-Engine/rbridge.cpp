@@ -22,6 +22,7 @@
 #include "appinfo.h"
 #include "tempfiles.h"
 #include "log.h"
+#include "tracer.h"
 
 DataSet		*rbridge_dataSet = NULL;
 RCallback	rbridge_callback = NULL;
@@ -29,16 +30,19 @@ boost::function<void(const std::string &, std::string &, std::string &)>	rbridge
 boost::function<void(std::string &, std::string &)>							rbridge_stateFileSource			= NULL,
 																			rbridge_jaspResultsFileSource	= NULL;
 boost::function<DataSet *()>	rbridge_dataSetSource = NULL;
+size_t							rbridge_snapshotVersion = 0, ///< What the running analysis pinned, 0 reads the live data
+								rbridge_snapshotSlot	= 0; ///< Of this engine, noted down in the DataSet while it holds the snapshot lock
 std::unordered_set<std::string> filterColumnsUsed;
 std::vector<std::string>		columnNamesInDataSet;
 boost::function<size_t()>		rbridge_getDataSetRowCount = NULL;
 
-boost::function<bool(const std::string&, const	std::vector<double>&)											> rbridge_setColumnDataAsScaleEngine		= NULL;
-boost::function<bool(const std::string&,		std::vector<int>&,			const std::map<int, std::string>&)	> rbridge_setColumnDataAsOrdinalEngine		= NULL;
-boost::function<bool(const std::string&,		std::vector<int>&,			const std::map<int, std::string>&)	> rbridge_setColumnDataAsNominalEngine		= NULL;
-boost::function<bool(const std::string&, const	std::vector<std::string>&)										> rbridge_setColumnDataAsNominalTextEngine	= NULL;
+boost::function<bool(const std::string&, const double *,	size_t																)> rbridge_setColumnDataAsScaleEngine		= NULL;
+boost::function<bool(const std::string&, const int *,		size_t,	const std::map<int, std::string>&	)> rbridge_setColumnDataAsOrdinalEngine		= NULL;
+boost::function<bool(const std::string&, const int *,		size_t,	const std::map<int, std::string>&	)> rbridge_setColumnDataAsNominalEngine		= NULL;
+boost::function<bool(const std::string&, const int *,		size_t,	const std::vector<std::string>&		)> rbridge_setColumnDataAsNominalTextEngine	= NULL;
 
 char** rbridge_getLabels(const Labels &levels, size_t &nbLevels);
+char** rbridge_getLabels(const Labels &levels, size_t &nbLevels, const char * columnName, uint64_t &labelsRevision);
 char** rbridge_getLabels(const std::vector<std::string> &levels, size_t &nbLevels);
 
 
@@ -71,7 +75,8 @@ void rbridge_init(sendFuncDef sendToDesktopFunction, pollMessagesFuncDef pollMes
 		rbridge_setColumnAsOrdinal,
 		rbridge_setColumnAsNominal,
 		rbridge_setColumnAsNominalText,
-		rbridge_dataSetRowCount
+		rbridge_dataSetRowCount,
+		rbridge_plotRenderCache
 	};
 
 	jaspRCPP_init(
@@ -87,14 +92,15 @@ void rbridge_init(sendFuncDef sendToDesktopFunction, pollMessagesFuncDef pollMes
 }
 
 void rbridge_setDataSetSource(			boost::function<DataSet* ()> source)												{	rbridge_dataSetSource			= source; }
+void rbridge_setSnapshotVersion(		size_t version, size_t slot)														{	rbridge_snapshotVersion			= version; rbridge_snapshotSlot = slot; }
 void rbridge_setFileNameSource(			boost::function<void (const std::string &, std::string &, std::string &)> source)	{	rbridge_fileNameSource			= source; }
 void rbridge_setStateFileSource(		boost::function<void (std::string &, std::string &)> source)						{	rbridge_stateFileSource			= source; }
 void rbridge_setJaspResultsFileSource(	boost::function<void (std::string &, std::string &)> source)						{	rbridge_jaspResultsFileSource	= source; }
 
-void rbridge_setColumnDataAsScaleSource(		boost::function<bool(const std::string &, const std::vector<double>&)													> source)	{	rbridge_setColumnDataAsScaleEngine			= source; }
-void rbridge_setColumnDataAsOrdinalSource(		boost::function<bool(const std::string &,		std::vector<int>&,					const std::map<int, std::string>&)	> source)	{	rbridge_setColumnDataAsOrdinalEngine		= source; }
-void rbridge_setColumnDataAsNominalSource(		boost::function<bool(const std::string &,		std::vector<int>&,					const std::map<int, std::string>&)	> source)	{	rbridge_setColumnDataAsNominalEngine		= source; }
-void rbridge_setColumnDataAsNominalTextSource(	boost::function<bool(const std::string &, const std::vector<std::string>&)												> source)	{	rbridge_setColumnDataAsNominalTextEngine	= source; }
+void rbridge_setColumnDataAsScaleSource(		boost::function<bool(const std::string &, const double *,	size_t																)> source)	{	rbridge_setColumnDataAsScaleEngine			= source; }
+void rbridge_setColumnDataAsOrdinalSource(		boost::function<bool(const std::string &, const int *,		size_t,	const std::map<int, std::string>&	)> source)	{	rbridge_setColumnDataAsOrdinalEngine		= source; }
+void rbridge_setColumnDataAsNominalSource(		boost::function<bool(const std::string &, const int *,		size_t,	const std::map<int, std::string>&	)> source)	{	rbridge_setColumnDataAsNominalEngine		= source; }
+void rbridge_setColumnDataAsNominalTextSource(	boost::function<bool(const std::string &, const int *,		size_t,	const std::vector<std::string>&		)> source)	{	rbridge_setColumnDataAsNominalTextEngine	= source; }
 
 void rbridge_setGetDataSetRowCountSource(boost::function<int()> source)	{	rbridge_getDataSetRowCount = source;	}
 
@@ -152,6 +158,15 @@ extern "C" const char* STDCALL rbridge_requestTempRootName()
 	return _root.c_str();
 }
 
+extern "C" bool STDCALL rbridge_plotRenderCache(const char* key, const char* relativePath, bool store, bool newPlot)
+{
+	if(!store)
+		return TempFiles::restoreFromRenderCache(key, relativePath);
+
+	TempFiles::copyToRenderCache(key, relativePath, newPlot);
+	return true;
+}
+
 extern "C" bool STDCALL rbridge_runCallback(const char* in, int progress, const char** out)
 {
 	if (!rbridge_callback)
@@ -191,7 +206,7 @@ std::string rbridge_runModuleCall(const std::string &name, const std::string &ti
 
 extern "C" RBridgeColumn* STDCALL rbridge_readFullDataSet(size_t * colMax)
 {
-	if (rbridge_dataSet == NULL)
+	if (rbridge_dataSet == NULL || SharedMemory::remapped())
 		rbridge_dataSet = rbridge_dataSetSource();
 
 	if(rbridge_dataSet == NULL)
@@ -220,7 +235,7 @@ extern "C" RBridgeColumn* STDCALL rbridge_readFullDataSet(size_t * colMax)
 
 extern "C" RBridgeColumn* STDCALL rbridge_readDataSetForFiltering(size_t * colMax)
 {
-	if (rbridge_dataSet == NULL)
+	if (rbridge_dataSet == NULL || SharedMemory::remapped())
 		rbridge_dataSet = rbridge_dataSetSource();
 
 	Columns &columns = rbridge_dataSet->columns();
@@ -254,17 +269,52 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSetForFiltering(size_t * colMa
 static RBridgeColumn*	datasetStatic = NULL;
 static int				datasetColMax = 0;
 
+// Bit i is set when row i passes the filter, but never more than maxSelected of them so the copies fit in what was allocated for the filtered rows
+static std::vector<uint64_t> rbridge_filterMask(const BoolVector & filterVector, size_t rowCount, size_t maxSelected)
+{
+	std::vector<uint64_t>	mask((rowCount + 63) / 64, 0);
+	size_t					selected = 0;
+
+	for(size_t row = 0; row < rowCount && row < filterVector.size() && selected < maxSelected; row++)
+		if(filterVector[row])
+		{
+			mask[row >> 6] |= uint64_t(1) << (row & 63);
+			selected++;
+		}
+
+	return mask;
+}
+
 extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHeaders, size_t colMax, bool obeyFilter)
 {
 	if (colHeaders == NULL)
 		return NULL;
 
+	JASPTRACE_SCOPE(rbridge_readDataSet);
+
 	rbridge_dataSet = rbridge_dataSetSource();
 
 	if(rbridge_dataSet == NULL)
 		return NULL;
 
-	Columns &columns = rbridge_dataSet->columns();
+	// Everything is read from the version that was pinned when the analysis started, even when the desktop changes the data in the meantime.
+	// The lock is only held while copying the filter and then each column, so the desktop never has to wait long for it.
+	// The filter is packed into a bitmask once, so the columns can be copied per block instead of testing it for every row of every column.
+	size_t					filteredRowCount;
+	std::vector<uint64_t>	filterMask;
+
+	{
+		DataSet::SnapshotLock	snapshotLock(*rbridge_dataSet, rbridge_snapshotSlot);
+		int						snapshotFilteredRowCount;
+		const BoolVector	&	filterVector		= rbridge_dataSet->snapshotFilter(rbridge_snapshotVersion, snapshotFilteredRowCount);
+
+		filteredRowCount = obeyFilter ? snapshotFilteredRowCount : rbridge_dataSet->rowCount();
+
+		if (obeyFilter)
+			filterMask = rbridge_filterMask(filterVector, rbridge_dataSet->rowCount(), filteredRowCount);
+	}
+
+	const std::vector<uint64_t>	*	rowMask = obeyFilter ? &filterMask : nullptr;
 
 	if (datasetStatic != NULL)
 		freeRBridgeColumns();
@@ -272,7 +322,7 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 	datasetColMax = colMax;
 	datasetStatic = static_cast<RBridgeColumn*>(calloc(datasetColMax + 1, sizeof(RBridgeColumn)));
 
-	size_t filteredRowCount = obeyFilter ? rbridge_dataSet->filteredRowCount() : rbridge_dataSet->rowCount();
+	JASPTRACE_COUNT(rowsMarshalled, filteredRowCount * colMax);
 
 	// lets make some rownumbers/names for R that takes into account being filtered or not!
 	datasetStatic[colMax].ints		= filteredRowCount == 0 ? NULL : static_cast<int*>(calloc(filteredRowCount, sizeof(int)));
@@ -280,28 +330,28 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 	int filteredRow					= 0;
 
 	for(size_t i=0; i<rbridge_dataSet->rowCount() && filteredRow < datasetStatic[colMax].nbRows; i++)
-		if(!obeyFilter || (rbridge_dataSet->filterVector().size() > i && rbridge_dataSet->filterVector()[i]))
+		if(!obeyFilter || ((filterMask[i >> 6] >> (i & 63)) & 1))
 			datasetStatic[colMax].ints[filteredRow++] = int(filteredRow + 1); //R needs 1-based index
 
 
 	for (int colNo = 0; colNo < colMax; colNo++)
 	{
+		DataSet::SnapshotLock snapshotLock(*rbridge_dataSet, rbridge_snapshotSlot);
+
 		RBridgeColumnType& columnInfo	= colHeaders[colNo];
 		RBridgeColumn& resultCol		= datasetStatic[colNo];
 
 		std::string columnName			= columnInfo.name;
 		resultCol.name					= strdup(Base64::encode("X", columnName, Base64::RVarEncoding).c_str());
 
-		Column &column					= columns.get(columnName);
+		Column &column					= rbridge_dataSet->snapshotColumn(columnName, rbridge_snapshotVersion);
 		Column::ColumnType columnType	= column.columnType();
 
 		Column::ColumnType requestedType = (Column::ColumnType)columnInfo.type;
 		if (requestedType == Column::ColumnTypeUnknown)
 			requestedType = columnType;
 
-		//int rowCount = column.rowCount();
 		resultCol.nbRows = filteredRowCount;
-		int rowNo = 0, dataSetRowNo = 0;
 
 		if (requestedType == Column::ColumnTypeScale)
 		{
@@ -311,9 +361,7 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 				resultCol.hasLabels	= false;
 				resultCol.doubles	= (double*)calloc(filteredRowCount, sizeof(double));
 
-				for(double value : column.AsDoubles)
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filterVector()[dataSetRowNo++]))
-						resultCol.doubles[rowNo++] = value;
+				column.copyValues(resultCol.doubles, filteredRowCount, rowMask);
 			}
 			else if (columnType == Column::ColumnTypeOrdinal || columnType == Column::ColumnTypeNominal)
 			{
@@ -321,9 +369,7 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 				resultCol.hasLabels	= false;
 				resultCol.ints		= filteredRowCount == 0 ? NULL : static_cast<int*>(calloc(filteredRowCount, sizeof(int)));
 
-				for(int value : column.AsInts)
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filterVector()[dataSetRowNo++]))
-						resultCol.ints[rowNo++] = value;
+				column.copyValues(resultCol.ints, filteredRowCount, rowMask);
 			}
 			else // columnType == Column::ColumnTypeNominalText
 			{
@@ -332,14 +378,9 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 				resultCol.isOrdinal = false;
 				resultCol.ints		= filteredRowCount == 0 ? NULL : static_cast<int*>(calloc(filteredRowCount, sizeof(int)));
 
-				for(int value : column.AsInts)
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filterVector()[dataSetRowNo++]))
-					{
-						if (value == INT_MIN)	resultCol.ints[rowNo++] = INT_MIN;
-						else					resultCol.ints[rowNo++] = value;
-					}
+				column.copyValues(resultCol.ints, filteredRowCount, rowMask);
 
-				resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels);
+				resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels, resultCol.name, resultCol.labelsRevision);
 			}
 		}
 		else // if (requestedType != Column::ColumnTypeScale)
@@ -359,14 +400,13 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 				for(const Label &label : labels)
 					indices[label.value()] = i++;
 
-				for(int value : column.AsInts)
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filterVector()[dataSetRowNo++]))
-					{
-						if (value == INT_MIN)	resultCol.ints[rowNo++] = INT_MIN;
-						else					resultCol.ints[rowNo++] = indices.at(value);
-					}
+				int copied = column.copyValues(resultCol.ints, filteredRowCount, rowMask);
 
-				resultCol.labels = rbridge_getLabels(labels, resultCol.nbLabels);
+				for(int rowNo = 0; rowNo < copied; rowNo++)
+					if (resultCol.ints[rowNo] != INT_MIN)
+						resultCol.ints[rowNo] = indices.at(resultCol.ints[rowNo]);
+
+				resultCol.labels = rbridge_getLabels(labels, resultCol.nbLabels, resultCol.name, resultCol.labelsRevision);
 			}
 			else
 			{
@@ -411,17 +451,18 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 					}
 				}
 
-				for(double value : column.AsDoubles)
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filterVector()[dataSetRowNo++]))
-					{
+				std::vector<double>	values(filteredRowCount);
+				int					copied = column.copyValues(values.data(), filteredRowCount, rowMask);
 
-						if (std::isnan(value))			resultCol.ints[rowNo] = INT_MIN;
-						else if (std::isfinite(value))	resultCol.ints[rowNo] = valueToIndex[(int)(value * 1000)] + 1;
-						else if (value > 0)				resultCol.ints[rowNo] = valueToIndex[INT_MAX] + 1;
-						else							resultCol.ints[rowNo] = valueToIndex[INT_MIN] + 1;
+				for(int rowNo = 0; rowNo < copied; rowNo++)
+				{
+					double value = values[rowNo];
 
-						rowNo++;
-					}
+					if (std::isnan(value))			resultCol.ints[rowNo] = INT_MIN;
+					else if (std::isfinite(value))	resultCol.ints[rowNo] = valueToIndex[(int)(value * 1000)] + 1;
+					else if (value > 0)				resultCol.ints[rowNo] = valueToIndex[INT_MAX] + 1;
+					else							resultCol.ints[rowNo] = valueToIndex[INT_MIN] + 1;
+				}
 
 				resultCol.labels = rbridge_getLabels(labels, resultCol.nbLabels);
 			}
@@ -433,7 +474,7 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 
 extern "C" char** STDCALL rbridge_readDataColumnNames(size_t * colMax)
 {
-	if (rbridge_dataSet == NULL)
+	if (rbridge_dataSet == NULL || SharedMemory::remapped())
 			rbridge_dataSet = rbridge_dataSetSource();
 
 	Columns &columns = rbridge_dataSet->columns();
@@ -468,20 +509,20 @@ extern "C" RBridgeColumnDescription* STDCALL rbridge_readDataSetDescription(RBri
 	lastColMax = colMax;
 	resultCols = (RBridgeColumnDescription*)calloc(colMax, sizeof(RBridgeColumnDescription));
 
-	if (rbridge_dataSet == NULL)
+	if (rbridge_dataSet == NULL || SharedMemory::remapped())
 		rbridge_dataSet = rbridge_dataSetSource();
 
-	Columns &columns = rbridge_dataSet->columns();
-
 	for (int colNo = 0; colNo < colMax; colNo++)
 	{
+		DataSet::SnapshotLock snapshotLock(*rbridge_dataSet, rbridge_snapshotSlot); // Per column, so the desktop doesn't have to wait for all of them
+
 		RBridgeColumnType& columnInfo = columnsType[colNo];
 		RBridgeColumnDescription& resultCol = resultCols[colNo];
 
 		std::string columnName = columnInfo.name;
 		resultCol.name = strdup(Base64::encode("X", columnName, Base64::RVarEncoding).c_str());
 
-		Column &column = columns.get(columnName);
+		Column &column = rbridge_dataSet->snapshotColumn(columnName, rbridge_snapshotVersion);
 		Column::ColumnType columnType = column.columnType();
 
 		Column::ColumnType requestedType = (Column::ColumnType)columnInfo.type;
@@ -506,7 +547,7 @@ extern "C" RBridgeColumnDescription* STDCALL rbridge_readDataSetDescription(RBri
 				resultCol.isScale = false;
 				resultCol.hasLabels = true;
 				resultCol.isOrdinal = false;
-				resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels);
+				resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels, resultCol.name, resultCol.labelsRevision);
 			}
 		}
 		else
@@ -516,7 +557,7 @@ extern "C" RBridgeColumnDescription* STDCALL rbridge_readDataSetDescription(RBri
 			resultCol.isOrdinal = (requestedType == Column::ColumnTypeOrdinal);
 			if (columnType != Column::ColumnTypeScale)
 			{
-				resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels);
+				resultCol.labels = rbridge_getLabels(column.labels(), resultCol.nbLabels, resultCol.name, resultCol.labelsRevision);
 			}
 			else
 			{
@@ -556,44 +597,42 @@ extern "C" RBridgeColumnDescription* STDCALL rbridge_readDataSetDescription(RBri
 	return resultCols;
 }
 
-extern "C" bool STDCALL rbridge_setColumnAsScale(const char* columnName, double * scalarData, size_t length)
+// The data is passed on as R has it, Column writes it straight into its blocks
+extern "C" bool STDCALL rbridge_setColumnAsScale(const char* columnName, const double * scalarData, size_t length)
 {
 	std::string colName(rbridge_decodeColumnNamesFromBase64(columnName));
-	std::vector<double> scalars(scalarData, scalarData + length);
 
-	return rbridge_setColumnDataAsScaleEngine(colName, scalars);
+	return rbridge_setColumnDataAsScaleEngine(colName, scalarData, length);
 }
 
-extern "C" bool STDCALL rbridge_setColumnAsOrdinal(const char* columnName, int * ordinalData, size_t length, const char ** levels, size_t numLevels)
+extern "C" bool STDCALL rbridge_setColumnAsOrdinal(const char* columnName, const int * ordinalData, size_t length, const char ** levels, size_t numLevels)
 {
 	std::string colName(rbridge_decodeColumnNamesFromBase64(columnName));
-	std::vector<int> ordinals(ordinalData, ordinalData + length);
 
 	std::map<int, std::string> labels;
 	for(size_t lvl=0; lvl<numLevels; lvl++)
 		labels[lvl + 1] = levels[lvl];
 
-	return rbridge_setColumnDataAsOrdinalEngine(colName, ordinals, labels);
+	return rbridge_setColumnDataAsOrdinalEngine(colName, ordinalData, length, labels);
 }
 
-extern "C" bool STDCALL rbridge_setColumnAsNominal(const char* columnName, int * nominalData, size_t length, const char ** levels, size_t numLevels)
+extern "C" bool STDCALL rbridge_setColumnAsNominal(const char* columnName, const int * nominalData, size_t length, const char ** levels, size_t numLevels)
 {
 	std::string colName(rbridge_decodeColumnNamesFromBase64(columnName));
-	std::vector<int> nominals(nominalData, nominalData + length);
 
 	std::map<int, std::string> labels;
 	for(size_t lvl=0; lvl<numLevels; lvl++)
 		labels[lvl + 1] = levels[lvl];
 
-	return rbridge_setColumnDataAsNominalEngine(colName, nominals, labels);
+	return rbridge_setColumnDataAsNominalEngine(colName, nominalData, length, labels);
 }
 
-extern "C" bool STDCALL rbridge_setColumnAsNominalText(const char* columnName, const char ** nominalData, size_t length)
+extern "C" bool STDCALL rbridge_setColumnAsNominalText(const char* columnName, const int * codes, size_t length, const char ** distinctValues, size_t numDistinct)
 {
 	std::string colName(rbridge_decodeColumnNamesFromBase64(columnName));
-	std::vector<std::string> nominals(nominalData, nominalData + length);
+	std::vector<std::string> distinct(distinctValues, distinctValues + numDistinct);
 
-	return rbridge_setColumnDataAsNominalTextEngine(colName, nominals);
+	return rbridge_setColumnDataAsNominalTextEngine(colName, codes, length, distinct);
 }
 
 extern "C" int	STDCALL rbridge_dataSetRowCount()
@@ -663,6 +702,20 @@ char** rbridge_getLabels(const Labels &levels, size_t &nbLevels)
 	return results;
 }
 
+// Returns NULL when R still has the levels of this revision, so they don't get copied for every analysis again
+char** rbridge_getLabels(const Labels &levels, size_t &nbLevels, const char * columnName, uint64_t &labelsRevision)
+{
+	labelsRevision = levels.revision();
+
+	if (jaspRCPP_levelsCached(columnName, labelsRevision))
+	{
+		nbLevels = 0;
+		return NULL;
+	}
+
+	return rbridge_getLabels(levels, nbLevels);
+}
+
 char** rbridge_getLabels(const std::vector<std::string> &levels, size_t &nbLevels)
 {
 	char** results = NULL;
@@ -759,7 +812,7 @@ std::string	rbridge_decodeColumnNamesFromBase64(const std::string & messageBase6
 
 void rbridge_findColumnsUsedInDataSet()
 {
-	if (rbridge_dataSet == NULL)
+	if (rbridge_dataSet == NULL || SharedMemory::remapped())
 		rbridge_dataSet = rbridge_dataSetSource();
 
 	Columns &columns = rbridge_dataSet->columns();
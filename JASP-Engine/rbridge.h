@@ -54,11 +54,12 @@ extern "C" {
 	bool						STDCALL rbridge_requestTempFileName(const char* extensionAsString, const char **root, const char **relativePath);
 	const char*					STDCALL rbridge_requestTempRootName();
 	bool						STDCALL rbridge_runCallback(const char* in, int progress, const char** out);
-	bool						STDCALL rbridge_setColumnAsScale		(const char* columnName, double *		scalarData,		size_t length);
-	bool						STDCALL rbridge_setColumnAsOrdinal		(const char* columnName, int *			ordinalData,	size_t length,	const char ** levels, size_t numLevels);
-	bool						STDCALL rbridge_setColumnAsNominal		(const char* columnName, int *			nominalData,	size_t length,	const char ** levels, size_t numLevels);
-	bool						STDCALL rbridge_setColumnAsNominalText	(const char* columnName, const char **	nominalData,	size_t length);
+	bool						STDCALL rbridge_setColumnAsScale		(const char* columnName, const double *	scalarData,		size_t length);
+	bool						STDCALL rbridge_setColumnAsOrdinal		(const char* columnName, const int *	ordinalData,	size_t length,	const char ** levels,			size_t numLevels);
+	bool						STDCALL rbridge_setColumnAsNominal		(const char* columnName, const int *	nominalData,	size_t length,	const char ** levels,			size_t numLevels);
+	bool						STDCALL rbridge_setColumnAsNominalText	(const char* columnName, const int *	codes,			size_t length,	const char ** distinctValues,	size_t numDistinct);
 	int							STDCALL rbridge_dataSetRowCount();
+	bool						STDCALL rbridge_plotRenderCache(const char* key, const char* relativePath, bool store, bool newPlot);
 }
 
 	typedef boost::function<std::string (const std::string &, int progress)> RCallback;
@@ -69,13 +70,14 @@ extern "C" {
 	void rbridge_setStateFileSource(		boost::function<void(std::string &, std::string &)> source);
 	void rbridge_setJaspResultsFileSource(	boost::function<void(std::string &, std::string &)> source);
 	void rbridge_setDataSetSource(			boost::function<DataSet *()> source);
+	void rbridge_setSnapshotVersion(		size_t version, size_t slot);
 
 	std::string rbridge_runModuleCall(const std::string &name, const std::string &title, const std::string &moduleCall, const std::string &dataKey, const std::string &options, const std::string &stateKey, const std::string &perform, int ppi, int analysisID, int analysisRevision, const std::string &imageBackground);
 
-	void rbridge_setColumnDataAsScaleSource(		boost::function< bool(const std::string&, const std::vector<double>&)											> source);
-	void rbridge_setColumnDataAsOrdinalSource(		boost::function< bool(const std::string&,		std::vector<int>&,			const std::map<int, std::string>&)	> source);
-	void rbridge_setColumnDataAsNominalSource(		boost::function< bool(const std::string&,		std::vector<int>&,			const std::map<int, std::string>&)	> source);
-	void rbridge_setColumnDataAsNominalTextSource(	boost::function< bool(const std::string&, const std::vector<std::string>&)										> source);
+	void rbridge_setColumnDataAsScaleSource(		boost::function< bool(const std::string&, const double *,	size_t																)> source);
+	void rbridge_setColumnDataAsOrdinalSource(		boost::function< bool(const std::string&, const int *,		size_t,	const std::map<int, std::string>&	)> source);
+	void rbridge_setColumnDataAsNominalSource(		boost::function< bool(const std::string&, const int *,		size_t,	const std::map<int, std::string>&	)> source);
+	void rbridge_setColumnDataAsNominalTextSource(	boost::function< bool(const std::string&, const int *,		size_t,	const std::vector<std::string>&		)> source);
 	void rbridge_setGetDataSetRowCountSource(		boost::function<int()> source);
 
 	std::string rbridge_run(const std::string &name, const std::string &title, const std::string &rfile, bool &requiresInit, const std::string &dataKey, const std::string &options, const std::string &resultsMeta, const std::string &stateKey, int analysisID, int analysisRevision, const std::string &perform = "run", int ppi = 96, const std::string &imageBackground = "white", RCallback callback = NULL, bool useJaspResults = false);
@@ -0,0 +1,128 @@
+#include "zygote.h"
+
+#include <map>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "processinfo.h"
+#include "log.h"
+
+static bool sendLine(int sock, const std::string & line)
+{
+	std::string	msg		= line + "\n";
+	size_t		sent	= 0;
+
+	while(sent < msg.size())
+	{
+		ssize_t bytes = ::send(sock, msg.data() + sent, msg.size() - sent, MSG_NOSIGNAL);
+
+		if(bytes <= 0)
+			return false;
+
+		sent += size_t(bytes);
+	}
+
+	return true;
+}
+
+///Lets the desktop know about any forked engine that stopped
+static void reapEngines(int sock, std::map<pid_t, int> & forked)
+{
+	int		status;
+	pid_t	pid;
+
+	while((pid = waitpid(-1, &status, WNOHANG)) > 0)
+	{
+		if(forked.count(pid) == 0)
+			continue;
+
+		bool	crashed		= WIFSIGNALED(status);
+		int		exitCode	= WIFEXITED(status) ? WEXITSTATUS(status) : WTERMSIG(status);
+
+		Log::log() << "Engine for channel " << forked[pid] << " with pid " << pid << (crashed ? " crashed" : " stopped") << " with " << exitCode << std::endl;
+
+		forked.erase(pid);
+		sendLine(sock, "exited " + std::to_string(pid) + " " + std::to_string(exitCode) + " " + (crashed ? "1" : "0"));
+	}
+}
+
+bool Zygote::forkEngines(const std::string & socketPath, int & slaveNo)
+{
+	int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+	if(sock < 0 || connect(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		Log::log() << "Zygote could not connect to \"" << socketPath << "\": " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	Log::log() << "Zygote is initialized and ready to fork engines." << std::endl;
+
+	std::map<pid_t, int>	forked;
+	std::string				received;
+
+	while(ProcessInfo::isParentRunning())
+	{
+		reapEngines(sock, forked);
+
+		pollfd request = { sock, POLLIN, 0 };
+
+		if(poll(&request, 1, 100) <= 0)
+			continue;
+
+		char	buffer[256];
+		ssize_t	bytes = read(sock, buffer, sizeof(buffer));
+
+		if(bytes <= 0)
+			break; //The desktop is gone
+
+		received.append(buffer, size_t(bytes));
+
+		for(size_t eol = received.find('\n'); eol != std::string::npos; eol = received.find('\n'))
+		{
+			std::string line = received.substr(0, eol);
+			received.erase(0, eol + 1);
+
+			if(line.compare(0, 5, "fork ") != 0)
+			{
+				Log::log() << "Zygote got an unknown request: " << line << std::endl;
+				continue;
+			}
+
+			int		channel	= std::stoi(line.substr(5));
+			pid_t	pid		= fork();
+
+			if(pid == 0)
+			{
+				close(sock);
+				slaveNo = channel;
+				return true;
+			}
+
+			if(pid < 0)
+			{
+				Log::log() << "Zygote could not fork an engine for channel " << channel << ": " << strerror(errno) << std::endl;
+				sendLine(sock, "failed " + std::to_string(channel));
+				continue;
+			}
+
+			forked[pid] = channel;
+			sendLine(sock, "forked " + std::to_string(channel) + " " + std::to_string(pid));
+		}
+	}
+
+	//Any engine still running would have a hard time without the desktop, but they notice that themselves.
+	close(sock);
+	return false;
+}
@@ -0,0 +1,18 @@
+#ifndef ZYGOTE_H
+#define ZYGOTE_H
+
+#include <string>
+
+///When started as zygote the engine initializes R once and then forks an engine for every channel the desktop asks for (only on linux).
+///See EngineZygote in JASP-Desktop for the other side of the socket.
+class Zygote
+{
+public:
+	///Returns true in a freshly forked engine, with slaveNo set to the channel it should use, and false when the zygote itself should stop.
+	static bool forkEngines(const std::string & socketPath, int & slaveNo);
+
+private:
+	Zygote() {}
+};
+
+#endif // ZYGOTE_H
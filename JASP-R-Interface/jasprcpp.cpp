@@ -18,6 +18,7 @@
 #include "jasprcpp.h"
 #include "jaspResults/src/jaspResults.h"
 #include <fstream>
+#include <unordered_map>
 
 
 static const	std::string NullString = "null";
@@ -42,6 +43,7 @@ SetColumnAsNominal			dataSetColumnAsNominal;
 SetColumnAsNominalText		dataSetColumnAsNominalText;
 
 DataSetRowCount				dataSetRowCount;
+PlotRenderCacheCB			plotRenderCacheCB;
 
 static logFlushDef			_logFlushFunction		= nullptr;
 static logWriteDef			_logWriteFunction		= nullptr;
@@ -76,6 +78,7 @@ void STDCALL jaspRCPP_init(const char* buildYear, const char* version, RBridgeCa
 	requestStateFileSourceCB				= callbacks->requestStateFileSourceCB;
 	dataSetColumnAsNominalText				= callbacks->dataSetColumnAsNominalText;
 	requestJaspResultsFileSourceCB			= callbacks->requestJaspResultsFileSourceCB;
+	plotRenderCacheCB						= callbacks->plotRenderCacheCB;
 
 	rInside[".dataSetRowCount"]				= Rcpp::InternalFunction(&jaspRCPP_dataSetRowCount);
 	rInside[".setLog"]						= Rcpp::InternalFunction(&jaspRCPP_setLog);
@@ -98,6 +101,8 @@ void STDCALL jaspRCPP_init(const char* buildYear, const char* version, RBridgeCa
 	rInside[".requestTempRootNameNative"]	= Rcpp::InternalFunction(&jaspRCPP_requestTempRootNameSEXP);
 	rInside[".setColumnDataAsNominalText"]	= Rcpp::InternalFunction(&jaspRCPP_setColumnDataAsNominalText);
 	rInside[".requestStateFileNameNative"]	= Rcpp::InternalFunction(&jaspRCPP_requestStateFileNameSEXP);
+	rInside[".plotRenderCacheKeyNative"]	= Rcpp::InternalFunction(&jaspRCPP_plotRenderCacheKey);
+	rInside[".plotRenderCacheNative"]		= Rcpp::InternalFunction(&jaspRCPP_plotRenderCache);
 
 	rInside.parseEvalQNT(".outputSink <- .createCaptureConnection(); sink(.outputSink); print('.outputSink initialized!');");
 
@@ -348,14 +353,15 @@ const char* STDCALL jaspRCPP_editImage(const char *name, const char *type, const
 }
 
 
-void STDCALL jaspRCPP_rewriteImages(const int ppi, const char* imageBackground) {
+void STDCALL jaspRCPP_rewriteImages(const char * name, const int ppi, const char* imageBackground) {
 
 	RInside &rInside = rinside->instance();
 
+	rInside["plotName"]			= name;
 	rInside[".ppi"]				= ppi;
 	rInside[".imageBackground"] = imageBackground;
 
-	jaspRCPP_parseEvalQNT("rewriteImages()");
+	jaspRCPP_parseEvalQNT("rewriteImages(plotName)");
 }
 
 
@@ -401,6 +407,30 @@ SEXP jaspRCPP_requestTempFileNameSEXP(SEXP extension)
 	return paths;
 }
 
+///FNV-1a of the png name and of the render parameters, used as folder and filename in the render cache.
+std::string jaspRCPP_plotRenderCacheKey(std::string relativePath, std::string renderParameters)
+{
+	auto hashString = [](const std::string & str)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+
+		for(unsigned char c : str)
+			hash = (hash ^ c) * 1099511628211ULL;
+
+		char hex[17];
+		snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+
+		return std::string(hex);
+	};
+
+	return hashString(relativePath) + "/" + hashString(renderParameters) + ".png";
+}
+
+bool jaspRCPP_plotRenderCache(std::string key, std::string relativePath, bool store, bool newPlot)
+{
+	return plotRenderCacheCB(key.c_str(), relativePath.c_str(), store, newPlot);
+}
+
 SEXP jaspRCPP_requestTempRootNameSEXP()
 {
 	const char* root = requestTempRootNameCB();
@@ -510,15 +540,7 @@ bool jaspRCPP_setColumnDataAsScale(std::string columnName, Rcpp::RObject scalarD
 
 bool _jaspRCPP_setColumnDataAsScale(std::string columnName, Rcpp::Vector<REALSXP> scalarData)
 {
-	double *scales = new double[scalarData.size()];
-	for(int i=0; i<scalarData.size(); i++)
-		scales[i] = scalarData[i];
-
-	bool somethingChanged = dataSetColumnAsScale(columnName.c_str(), scales, static_cast<size_t>(scalarData.size()));
-
-	delete[] scales;
-
-	return somethingChanged;
+	return dataSetColumnAsScale(columnName.c_str(), REAL(scalarData), static_cast<size_t>(scalarData.size()));
 }
 
 
@@ -539,23 +561,7 @@ bool jaspRCPP_setColumnDataAsOrdinal(std::string columnName, Rcpp::RObject ordin
 
 bool _jaspRCPP_setColumnDataAsOrdinal(std::string columnName, Rcpp::Vector<INTSXP> ordinalData)
 {
-	int *ordinals = new int[ordinalData.size()];
-	for(int i=0; i<ordinalData.size(); i++)
-		ordinals[i] = ordinalData[i];
-
-	size_t			numLevels;
-	const char **	labelPointers;
-	std::string *	labels;
-
-	jaspRCPP_setColumnDataHelper_FactorsLevels(ordinalData, ordinals, numLevels, labelPointers, labels);
-
-	bool somethingChanged =  dataSetColumnAsOrdinal(columnName.c_str(), ordinals, static_cast<size_t>(ordinalData.size()), labelPointers, numLevels);
-
-	delete[] ordinals;
-	delete[] labels;
-	delete[] labelPointers;
-
-	return somethingChanged;
+	return jaspRCPP_setColumnDataHelper_Factor(columnName, ordinalData, dataSetColumnAsOrdinal);
 }
 
 bool jaspRCPP_setColumnDataAsNominal(std::string columnName, Rcpp::RObject nominalData)
@@ -575,23 +581,7 @@ bool jaspRCPP_setColumnDataAsNominal(std::string columnName, Rcpp::RObject nomin
 
 bool _jaspRCPP_setColumnDataAsNominal(std::string columnName, Rcpp::Vector<INTSXP> nominalData)
 {
-	int *nominals = new int[nominalData.size()];
-	for(int i=0; i<nominalData.size(); i++)
-		nominals[i] = nominalData[i];
-
-	size_t			numLevels;
-	const char **	labelPointers;
-	std::string *	labels;
-
-	jaspRCPP_setColumnDataHelper_FactorsLevels(nominalData, nominals, numLevels, labelPointers, labels);
-
-	bool somethingChanged =  dataSetColumnAsNominal(columnName.c_str(), nominals, static_cast<size_t>(nominalData.size()), labelPointers, numLevels);
-
-	delete[] nominals;
-	delete[] labels;
-	delete[] labelPointers;
-
-	return somethingChanged;
+	return jaspRCPP_setColumnDataHelper_Factor(columnName, nominalData, dataSetColumnAsNominal);
 }
 
 bool jaspRCPP_setColumnDataAsNominalText(std::string columnName, Rcpp::RObject nominalData)
@@ -605,64 +595,67 @@ bool jaspRCPP_setColumnDataAsNominalText(std::string columnName, Rcpp::RObject n
 
 bool _jaspRCPP_setColumnDataAsNominalText(std::string columnName, Rcpp::Vector<STRSXP> nominalData)
 {
-	std::vector<std::string> convertedStrings(nominalData.begin(), nominalData.end());
+	// R caches CHARSXPs, so the pointers can be dictionary-encoded without copying or even hashing the text.
+	// The cache also tells the encoding mark apart though, the same text may therefore still show up twice in distinct: Column merges those.
+	std::unordered_map<SEXP, int>	codeOf;
+	std::vector<const char *>		distinct;
+	std::vector<int>				codes(nominalData.size());
+
+	for(R_xlen_t i=0; i<nominalData.size(); i++)
+	{
+		SEXP	str		= STRING_ELT(nominalData, i);
+		auto	code	= codeOf.find(str);
 
-	const char ** nominals = new const char*[convertedStrings.size()]();
+		if(code == codeOf.end())
+		{
+			code = codeOf.insert(std::make_pair(str, int(distinct.size()))).first;
+			distinct.push_back(CHAR(str));
+		}
 
-	for(size_t i=0; i<convertedStrings.size(); i++)
-		nominals[i] = convertedStrings[i].c_str();
+		codes[i] = code->second;
+	}
 
-	return dataSetColumnAsNominalText(columnName.c_str(), nominals, static_cast<size_t>(nominalData.size()));
+	return dataSetColumnAsNominalText(columnName.c_str(), codes.data(), codes.size(), distinct.data(), distinct.size());
 }
 
-
-void jaspRCPP_setColumnDataHelper_FactorsLevels(Rcpp::Vector<INTSXP> data, int *& outputData, size_t & numLevels, const char **& labelPointers, std::string *& labels)
+bool jaspRCPP_setColumnDataHelper_Factor(const std::string & columnName, Rcpp::Vector<INTSXP> data, SetColumnAsNominal setColumn)
 {
-	Rcpp::CharacterVector	levels;
-	numLevels = 0;
+	const int *					values = INTEGER(data);
+	std::vector<int>			remapped;
+	std::vector<std::string>	labels;
+	std::vector<const char *>	labelPointers;
 
 	if(!Rf_isNull(data.attr("levels")))
 	{
-		levels = data.attr("levels");
-		numLevels = size_t(levels.size());
-	}
-
-	if(numLevels > 0)
-	{
-		labels			= new std::string [numLevels];
-		labelPointers	= new const char * [numLevels];
+		// The levels stay alive as an attribute of data, so they can be passed on as they are
+		Rcpp::CharacterVector levels = data.attr("levels");
 
-		for(int i=0; i<numLevels; i++)
-		{
-			labels[i]			= levels[i];
-			labelPointers[i]	= labels[i].c_str();
-		}
+		for(R_xlen_t i=0; i<levels.size(); i++)
+			labelPointers.push_back(CHAR(STRING_ELT(levels, i)));
 	}
 	else
 	{
-		std::set<int> unique;
-		for(int i=0; i<data.size(); i++)
-			unique.insert(outputData[i]);
-		numLevels = unique.size();
-
-		std::vector<int> sorted(unique.begin(), unique.end());
-		std::sort(sorted.begin(), sorted.end());
-
-		labels			= new std::string [numLevels];
-		labelPointers	= new const char * [numLevels];
+		std::set<int> unique(values, values + data.size());
 
-		std::map<std::string, int> levelToVal;
+		std::map<int, int> valueToLevel;
 
-		for(size_t i=0; i<sorted.size(); i++)
+		for(int value : unique)
 		{
-			labels[i]				= std::to_string(sorted[i]);
-			labelPointers[i]		= labels[i].c_str();
-			levelToVal[labels[i]]	= i + 1;
+			valueToLevel[value] = labels.size() + 1;
+			labels.push_back(std::to_string(value));
 		}
 
-		for(int i=0; i<data.size(); i++)
-			outputData[i] = levelToVal[std::to_string(outputData[i])];;
+		for(const std::string & label : labels)
+			labelPointers.push_back(label.c_str());
+
+		remapped.reserve(data.size());
+		for(R_xlen_t i=0; i<data.size(); i++)
+			remapped.push_back(valueToLevel[values[i]]);
+
+		values = remapped.data();
 	}
+
+	return setColumn(columnName.c_str(), values, static_cast<size_t>(data.size()), labelPointers.data(), labelPointers.size());
 }
 
 
@@ -765,7 +758,7 @@ Rcpp::DataFrame jaspRCPP_convertRBridgeColumns_to_DataFrame(const RBridgeColumn*
 			else if(!colResult.hasLabels)
 				list[i] = Rcpp::IntegerVector(colResult.ints, colResult.ints + colResult.nbRows);
 			else
-				list[i] = jaspRCPP_makeFactor(Rcpp::IntegerVector(colResult.ints, colResult.ints + colResult.nbRows), colResult.labels, colResult.nbLabels, colResult.isOrdinal);
+				list[i] = jaspRCPP_makeFactor(Rcpp::IntegerVector(colResult.ints, colResult.ints + colResult.nbRows), jaspRCPP_levels(colResult.name, colResult.labelsRevision, colResult.labels, colResult.nbLabels), colResult.isOrdinal);
 
 		}
 
@@ -804,7 +797,7 @@ Rcpp::DataFrame jaspRCPP_readDataSetHeaderSEXP(SEXP columns, SEXP columnsAsNumer
 			else if (!colDescription.hasLabels)
 				list(i) = Rcpp::IntegerVector(0);
 			else
-				list(i) = jaspRCPP_makeFactor(Rcpp::IntegerVector(0), colDescription.labels, colDescription.nbLabels, colDescription.isOrdinal);
+				list(i) = jaspRCPP_makeFactor(Rcpp::IntegerVector(0), jaspRCPP_levels(colDescription.name, colDescription.labelsRevision, colDescription.labels, colDescription.nbLabels), colDescription.isOrdinal);
 		}
 
 		list.attr("names") = columnNames;
@@ -815,28 +808,53 @@ Rcpp::DataFrame jaspRCPP_readDataSetHeaderSEXP(SEXP columns, SEXP columnsAsNumer
 
 }
 
-Rcpp::IntegerVector jaspRCPP_makeFactor(Rcpp::IntegerVector v, char** levels, int nbLevels, bool ordinal)
+struct jaspRCPP_CachedLevels
 {
-/*#ifdef JASP_DEBUG
-	std::cout << "jaspRCPP_makeFactor:\n\tlevels:\n\t\tnum: " << nbLevels << "\n\t\tstrs:\n";
-	for(int i=0; i<nbLevels; i++)
-		std::cout << "\t\t\t'" << levels[i] << "'\n";
-	std::cout << "intVec: ";
+	uint64_t	revision;
+	SEXP		levels;
+};
+
+///Per column (keyed on the encoded name) the levels R got last, they stay preserved until the labels of that column change.
+static std::map<std::string, jaspRCPP_CachedLevels> _levelsCache;
 
-	for(int i=0; i<v.size(); i++)
-		std::cout << v[i] << (i < v.size() - 1 ? ", " : "" );
-	std::cout << std::endl;
-#endif*/
+bool STDCALL jaspRCPP_levelsCached(const char * columnName, uint64_t labelsRevision)
+{
+	auto cached = _levelsCache.find(columnName);
+	return labelsRevision != 0 && cached != _levelsCache.end() && cached->second.revision == labelsRevision;
+}
+
+Rcpp::CharacterVector jaspRCPP_levels(const char * columnName, uint64_t labelsRevision, char** levels, size_t nbLevels)
+{
+	if(jaspRCPP_levelsCached(columnName, labelsRevision))
+		return Rcpp::CharacterVector(_levelsCache[columnName].levels);
 
 	Rcpp::CharacterVector labels(nbLevels);
-	for (int i = 0; i < nbLevels; i++)
+	for (size_t i = 0; i < nbLevels; i++)
 	{
 		Rcpp::String s = levels[i];
 		s.set_encoding(Encoding);
 		labels[i] = s;
 	}
 
+	if(labelsRevision != 0)
+	{
+		jaspRCPP_CachedLevels & cached = _levelsCache[columnName];
+
+		if(cached.levels != nullptr)
+			R_ReleaseObject(cached.levels);
+
+		cached.revision	= labelsRevision;
+		cached.levels	= labels;
+
+		MARK_NOT_MUTABLE(cached.levels); //It is shared by all factors made from it
+		R_PreserveObject(cached.levels);
+	}
+
+	return labels;
+}
 
+Rcpp::IntegerVector jaspRCPP_makeFactor(Rcpp::IntegerVector v, Rcpp::CharacterVector labels, bool ordinal)
+{
 	v.attr("levels") = labels;
 
 	std::vector<std::string> rClass;
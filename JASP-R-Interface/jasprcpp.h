@@ -51,6 +51,9 @@ void jaspRCPP_setLog(SEXP Message);
 
 int jaspRCPP_dataSetRowCount();
 
+std::string	jaspRCPP_plotRenderCacheKey(std::string relativePath, std::string renderParameters);
+bool		jaspRCPP_plotRenderCache(std::string key, std::string relativePath, bool store, bool newPlot);
+
 bool jaspRCPP_setColumnDataAsScale(std::string columnName,			Rcpp::RObject scalarData);
 bool jaspRCPP_setColumnDataAsOrdinal(std::string columnName,		Rcpp::RObject ordinalData);
 bool jaspRCPP_setColumnDataAsNominal(std::string columnName,		Rcpp::RObject nominalData);
@@ -61,7 +64,7 @@ bool _jaspRCPP_setColumnDataAsOrdinal(std::string columnName,		Rcpp::Vector<INTS
 bool _jaspRCPP_setColumnDataAsNominal(std::string columnName,		Rcpp::Vector<INTSXP> nominalData);
 bool _jaspRCPP_setColumnDataAsNominalText(std::string columnName,	Rcpp::Vector<STRSXP> nominalData);
 
-void jaspRCPP_setColumnDataHelper_FactorsLevels(Rcpp::Vector<INTSXP> data, int *& outputData, size_t & numLevels, const char **& labelPointers, std::string *& labels);
+bool jaspRCPP_setColumnDataHelper_Factor(const std::string & columnName, Rcpp::Vector<INTSXP> data, SetColumnAsNominal setColumn); ///< Ordinal and nominal only differ in the callback
 
 //Calls from JASPresult (from R)
 typedef void (*sendFuncDef)(const char *);
@@ -71,7 +74,8 @@ enum ColumnType { ColumnTypeUnknown = 0, ColumnTypeNominal = 1, ColumnTypeNomina
 
 RBridgeColumnType* jaspRCPP_marshallSEXPs(SEXP columns, SEXP columnsAsNumeric, SEXP columnsAsOrdinal, SEXP columnsAsNominal, SEXP allColumns, size_t * colMax);
 
-Rcpp::IntegerVector jaspRCPP_makeFactor(Rcpp::IntegerVector v, char** levels, int nbLevels, bool ordinal = false);
+Rcpp::CharacterVector	jaspRCPP_levels(const char * columnName, uint64_t labelsRevision, char** levels, size_t nbLevels);
+Rcpp::IntegerVector		jaspRCPP_makeFactor(Rcpp::IntegerVector v, Rcpp::CharacterVector labels, bool ordinal = false);
 void freeRBridgeColumnType(RBridgeColumnType* columnsRequested, size_t colMax);
 
 std::string _jaspRCPP_System(std::string cmd);
@@ -38,6 +38,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdint.h>
 
 extern "C" {
 
@@ -51,6 +52,7 @@ struct RBridgeColumn {
   char**  labels;
   size_t  nbRows;
   size_t  nbLabels;
+  uint64_t labelsRevision; //0 when the labels aren't from the dataset, otherwise labels is NULL when jaspRCPP_levelsCached already has them
 } ;
 
 struct RBridgeColumnDescription {
@@ -61,6 +63,7 @@ struct RBridgeColumnDescription {
   bool    isOrdinal;
 	char**	labels;
   size_t  nbLabels;
+  uint64_t labelsRevision;
 } ;
 
 struct RBridgeColumnType {
@@ -77,11 +80,12 @@ typedef bool						(STDCALL *RequestSpecificFileSourceCB)	(const char **root, con
 typedef bool						(STDCALL *RequestTempFileNameCB)        (const char* extensionAsString, const char **root, const char **relativePath);
 typedef const char*					(STDCALL *RequestTempRootNameCB)        ();
 typedef bool						(STDCALL *RunCallbackCB)                (const char* in, int progress, const char** out);
-typedef bool						(STDCALL *SetColumnAsScale)             (const char* columnName, double *       scalarData,		size_t length);
-typedef bool						(STDCALL *SetColumnAsOrdinal)           (const char* columnName, int *          ordinalData,	size_t length, const char ** levels, size_t numLevels);
-typedef bool						(STDCALL *SetColumnAsNominal)           (const char* columnName, int *          nominalData,	size_t length, const char ** levels, size_t numLevels);
-typedef bool						(STDCALL *SetColumnAsNominalText)       (const char* columnName, const char **	nominalData,	size_t length);
+typedef bool						(STDCALL *SetColumnAsScale)             (const char* columnName, const double * scalarData,		size_t length);
+typedef bool						(STDCALL *SetColumnAsOrdinal)           (const char* columnName, const int *    ordinalData,	size_t length, const char ** levels, size_t numLevels);
+typedef bool						(STDCALL *SetColumnAsNominal)           (const char* columnName, const int *    nominalData,	size_t length, const char ** levels, size_t numLevels);
+typedef bool						(STDCALL *SetColumnAsNominalText)       (const char* columnName, const int *	codes,			size_t length, const char ** distinctValues, size_t numDistinct); //codes index distinctValues
 typedef int							(STDCALL *DataSetRowCount)              ();
+typedef bool						(STDCALL *PlotRenderCacheCB)            (const char* key, const char* relativePath, bool store, bool newPlot);
 
 
 struct RBridgeCallBacks {
@@ -100,6 +104,7 @@ struct RBridgeCallBacks {
 	SetColumnAsNominal			dataSetColumnAsNominal;
 	SetColumnAsNominalText		dataSetColumnAsNominalText;
 	DataSetRowCount				dataSetRowCount;
+	PlotRenderCacheCB			plotRenderCacheCB;
 };
 
 typedef void	(*sendFuncDef)			(const char *);
@@ -115,7 +120,7 @@ RBRIDGE_TO_JASP_INTERFACE const char*	STDCALL jaspRCPP_check();
 
 RBRIDGE_TO_JASP_INTERFACE const char*	STDCALL jaspRCPP_saveImage(const char *name, const char *type, const int height, const int width, const int ppi, const char* imageBackground);
 RBRIDGE_TO_JASP_INTERFACE const char*	STDCALL jaspRCPP_editImage(const char *name, const char *type, const int height, const int width, const int ppi, const char* imageBackground);
-RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_rewriteImages(const int ppi, const char* imageBackground);
+RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_rewriteImages(const char * name, const int ppi, const char* imageBackground);
 
 RBRIDGE_TO_JASP_INTERFACE const char*	STDCALL jaspRCPP_runModuleCall(const char* name, const char* title, const char* moduleCall, const char* dataKey, const char* options, const char* stateKey, const char* perform, int ppi, int analysisID, int analysisRevision, const char* imageBackground);
 
@@ -125,6 +130,7 @@ RBRIDGE_TO_JASP_INTERFACE const char*	STDCALL jaspRCPP_evalRCode(const char *rCo
 
 RBRIDGE_TO_JASP_INTERFACE int			STDCALL jaspRCPP_runFilter(const char * filtercode, bool ** arraypointer); //arraypointer points to a pointer that will contain the resulting list of filter-booleans if jaspRCPP_runFilter returns > 0
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_freeArrayPointer(bool ** arrayPointer);
+RBRIDGE_TO_JASP_INTERFACE bool			STDCALL jaspRCPP_levelsCached(const char * columnName, uint64_t labelsRevision); //If true rbridge doesn't need to pass the labels of that column again
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_runScript(const char * scriptCode);
 RBRIDGE_TO_JASP_INTERFACE const char *	STDCALL jaspRCPP_runScriptReturnString(const char * scriptCode);
 
@@ -0,0 +1,24 @@
+QT += testlib
+QT -= gui
+
+include(../../JASP.pri)
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = JASP-Common-Tests
+
+INCLUDEPATH += $$PWD/../../JASP-Common/
+
+PRE_TARGETDEPS += ../../JASP-Common
+LIBS += -L../.. -lJASP-Common
+
+windows {
+	CONFIG(ReleaseBuild)	LIBS += -llibboost_filesystem-vc141-mt-1_64 -llibboost_system-vc141-mt-1_64
+	CONFIG(DebugBuild)		LIBS += -llibboost_filesystem-vc141-mt-gd-1_64 -llibboost_system-vc141-mt-gd-1_64
+}
+macx:	LIBS += -lboost_filesystem-clang-mt-1_64 -lboost_system-clang-mt-1_64
+linux:	LIBS += -lboost_filesystem -lboost_system -lrt
+
+SOURCES += \
+	emptyvaluestest.cpp
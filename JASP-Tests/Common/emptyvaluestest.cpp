@@ -0,0 +1,49 @@
+#include <QtTest>
+#include <cmath>
+#include "utils.h"
+
+///Checks Utils::isEmptyValue, which decides per cell whether it is shown as missing.
+class EmptyValuesTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void init()
+	{
+		Utils::setEmptyValues(Utils::getDefaultEmptyValues());
+	}
+
+	void numbersAreNotEmptyByDefault()
+	{
+		for(double value : { 1.0, 3.5, -2.0, 0.0, 999.0 })
+			QVERIFY2(!Utils::isEmptyValue(value), qPrintable(QString::number(value)));
+	}
+
+	void nanIsEmpty()
+	{
+		QVERIFY(Utils::isEmptyValue(NAN));
+	}
+
+	void numericEmptyValues()
+	{
+		Utils::setEmptyValues({ "NaN", "nan", "-999", "99" });
+
+		QVERIFY(Utils::isEmptyValue(-999.0));
+		QVERIFY(Utils::isEmptyValue(99.0));
+		QVERIFY(!Utils::isEmptyValue(1.0));
+		QVERIFY(!Utils::isEmptyValue(-998.0));
+	}
+
+	void stringEmptyValues()
+	{
+		QVERIFY(Utils::isEmptyValue(std::string("")));
+		QVERIFY(Utils::isEmptyValue(std::string("NA")));
+		QVERIFY(Utils::isEmptyValue(std::string(".")));
+		QVERIFY(!Utils::isEmptyValue(std::string("1")));
+		QVERIFY(!Utils::isEmptyValue(std::string("NAN")));
+	}
+};
+
+QTEST_APPLESS_MAIN(EmptyValuesTest)
+
+#include "emptyvaluestest.moc"